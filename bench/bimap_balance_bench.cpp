@@ -0,0 +1,134 @@
+// sorted insert into the red-black bimap against the never rebalanced search trees it replaced.
+//   g++ -std=c++20 -O2 bench/bimap_balance_bench.cpp -o bimap_balance_bench
+//   ./bimap_balance_bench [max size]
+// sizes go from 1K up to max size (10M by default) in steps of 10. increasing keys turn the
+// unbalanced trees into lists, so their runs stop once one takes longer than BASELINE_SECONDS.
+// ns/op divided by log2(size) stays flat when insertion is O(n log n) overall
+
+#include "../bimap/bimap.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+namespace {
+
+using clock_type = std::chrono::steady_clock;
+
+constexpr double BASELINE_SECONDS = 5;
+
+// the previous bimap_components::map: every pair hangs in a plain search tree per side
+class unbalanced_bimap {
+  struct node {
+    int left_key;
+    int right_key;
+    node* left_children[2] = {nullptr, nullptr};
+    node* right_children[2] = {nullptr, nullptr};
+  };
+
+public:
+  unbalanced_bimap() = default;
+
+  unbalanced_bimap(const unbalanced_bimap&) = delete;
+  unbalanced_bimap& operator=(const unbalanced_bimap&) = delete;
+
+  ~unbalanced_bimap() {
+    for (node* nd : nodes_) {
+      delete nd;
+    }
+  }
+
+  bool insert(int left, int right) {
+    node** left_slot = &left_root_;
+    while (*left_slot != nullptr) {
+      if ((*left_slot)->left_key == left) {
+        return false;
+      }
+      left_slot = &(*left_slot)->left_children[(*left_slot)->left_key < left];
+    }
+    node** right_slot = &right_root_;
+    while (*right_slot != nullptr) {
+      if ((*right_slot)->right_key == right) {
+        return false;
+      }
+      right_slot = &(*right_slot)->right_children[(*right_slot)->right_key < right];
+    }
+    nodes_.push_back(new node{left, right});
+    *left_slot = nodes_.back();
+    *right_slot = nodes_.back();
+    return true;
+  }
+
+  bool contains_left(int left) const {
+    node* nd = left_root_;
+    while (nd != nullptr && nd->left_key != left) {
+      nd = nd->left_children[nd->left_key < left];
+    }
+    return nd != nullptr;
+  }
+
+private:
+  node* left_root_ = nullptr;
+  node* right_root_ = nullptr;
+  std::vector<node*> nodes_;
+};
+
+struct timing {
+  double insert_seconds;
+  double find_seconds;
+};
+
+template <typename Map, typename Contains>
+timing run(std::size_t n, Contains contains) {
+  volatile std::size_t sink = 0;
+  Map map;
+  auto begin = clock_type::now();
+  for (std::size_t i = 0; i < n; ++i) {
+    map.insert(static_cast<int>(i), -static_cast<int>(i));
+  }
+  double insert_seconds = std::chrono::duration<double>(clock_type::now() - begin).count();
+  std::size_t found = 0;
+  begin = clock_type::now();
+  for (std::size_t i = 0; i < n; ++i) {
+    found += contains(map, static_cast<int>(i));
+  }
+  double find_seconds = std::chrono::duration<double>(clock_type::now() - begin).count();
+  sink = sink + found;
+  return {insert_seconds, find_seconds};
+}
+
+void report(const char* tree, std::size_t n, const timing& t) {
+  double ops = static_cast<double>(n);
+  double log_n = std::log2(ops);
+  std::printf(
+      "%-10s %10zu %12.3f %14.1f %14.2f %14.1f\n", tree, n, t.insert_seconds, t.insert_seconds * 1e9 / ops,
+      t.insert_seconds * 1e9 / ops / log_n, t.find_seconds * 1e9 / ops
+  );
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  std::size_t max_size = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 10'000'000;
+
+  std::printf(
+      "%-10s %10s %12s %14s %14s %14s\n", "tree", "size", "insert s", "insert ns/op", "ns/op/log2 n",
+      "find ns/op"
+  );
+  bool baseline = true;
+  for (std::size_t n = 1'000; n <= max_size; n *= 10) {
+    report("red-black", n, run<bimap<int, int>>(n, [](const bimap<int, int>& b, int key) {
+      return b.find_left(key) != b.end_left();
+    }));
+    if (!baseline) {
+      std::printf("%-10s %10zu skipped, quadratic\n", "unbalanced", n);
+      continue;
+    }
+    timing t = run<unbalanced_bimap>(n, [](const unbalanced_bimap& b, int key) { return b.contains_left(key); });
+    report("unbalanced", n, t);
+    baseline = t.insert_seconds < BASELINE_SECONDS;
+  }
+}
@@ -0,0 +1,191 @@
+// ns/op and allocations/op of the bimap backends: red-black tree, B-tree, flat and unordered.
+//   g++ -std=c++20 -O2 bench/bimap_bench.cpp -o bimap_bench
+//   ./bimap_bench [max size]
+// sizes go from 1K up to max size (10M by default) in steps of 10. the flat bimap pays O(n) for
+// every insertion, so its insert cases and at_left_or_default stop at FLAT_LIMIT; the table the
+// other cases run on is built with the range constructor
+
+#include "../bimap/bimap.h"
+#include "../bimap/flat-bimap.h"
+#include "../bimap/unordered-bimap.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <iterator>
+#include <new>
+#include <numeric>
+#include <random>
+#include <utility>
+#include <vector>
+
+namespace {
+
+std::size_t allocations = 0;
+
+} // namespace
+
+// out of line, so the compiler does not pair the malloc behind new with a sized delete
+[[gnu::noinline]] void* operator new(std::size_t size) {
+  ++allocations;
+  if (void* p = std::malloc(size != 0 ? size : 1)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+[[gnu::noinline]] void operator delete(void* p) noexcept {
+  std::free(p);
+}
+
+[[gnu::noinline]] void operator delete(void* p, std::size_t) noexcept {
+  std::free(p);
+}
+
+namespace {
+
+using clock_type = std::chrono::steady_clock;
+
+constexpr std::size_t FLAT_LIMIT = 100'000;
+
+// every case is repeated until it has done this many operations or run for MAX_SECONDS
+constexpr std::size_t MIN_OPS = 1 << 20;
+
+constexpr double MAX_SECONDS = 0.5;
+
+// left keys are 2 * i and right keys are i for i in [0, n), odd left keys and right keys
+// from n on miss. the right key 0 is taken, so every missing at_left_or_default steals it
+struct keys {
+  explicit keys(std::size_t n) : sorted(n), shuffled(n) {
+    std::iota(sorted.begin(), sorted.end(), 0);
+    shuffled = sorted;
+    std::shuffle(shuffled.begin(), shuffled.end(), std::mt19937_64(n));
+  }
+
+  std::vector<int> sorted;
+  std::vector<int> shuffled;
+};
+
+struct measurement {
+  double seconds = 0;
+  std::size_t allocations = 0;
+  std::size_t ops = 0;
+};
+
+void report(const char* backend, std::size_t n, const char* name, const measurement& m) {
+  double ops = static_cast<double>(m.ops);
+  std::printf(
+      "%-10s %10zu %-22s %12.1f %12.3f\n", backend, n, name, m.seconds * 1e9 / ops,
+      static_cast<double>(m.allocations) / ops
+  );
+}
+
+// calls setup and then the timed body, which returns the number of operations it did
+template <typename Setup, typename Body>
+measurement measure(Setup setup, Body body) {
+  measurement res;
+  while (res.ops < MIN_OPS && res.seconds < MAX_SECONDS) {
+    auto state = setup();
+    std::size_t before = allocations;
+    auto begin = clock_type::now();
+    res.ops += body(state);
+    res.seconds += std::chrono::duration<double>(clock_type::now() - begin).count();
+    res.allocations += allocations - before;
+  }
+  return res;
+}
+
+template <typename Map>
+void run(const char* backend, std::size_t n, const keys& k, bool linear_insert) {
+  bool slow_inserts = linear_insert && n > FLAT_LIMIT;
+  std::vector<int> reversed(k.sorted.rbegin(), k.sorted.rend());
+  volatile std::size_t sink = 0;
+
+  auto none = [] { return 0; };
+
+  auto insert_case = [&](const char* name, const std::vector<int>& order) {
+    if (slow_inserts) {
+      return;
+    }
+    report(backend, n, name, measure(none, [&](int) {
+      Map map;
+      for (int i : order) {
+        map.insert(2 * i, i);
+      }
+      sink = sink + map.size();
+      return n;
+    }));
+  };
+  insert_case("insert random", k.shuffled);
+  insert_case("insert sorted", k.sorted);
+  insert_case("insert reverse", reversed);
+
+  std::vector<std::pair<int, int>> pairs(n);
+  for (std::size_t i = 0; i < n; ++i) {
+    pairs[i] = {2 * k.shuffled[i], k.shuffled[i]};
+  }
+  Map map(pairs.begin(), pairs.end());
+  pairs = {};
+  auto lookup_case = [&](const char* name, auto find) {
+    report(backend, n, name, measure(none, [&](int) {
+      std::size_t found = 0;
+      for (int i : k.shuffled) {
+        found += find(i);
+      }
+      sink = sink + found;
+      return n;
+    }));
+  };
+  lookup_case("find_left hit", [&](int i) { return map.find_left(2 * i) != map.end_left(); });
+  lookup_case("find_left miss", [&](int i) { return map.find_left(2 * i + 1) != map.end_left(); });
+  lookup_case("find_right hit", [&](int i) { return map.find_right(i) != map.end_right(); });
+  lookup_case("find_right miss", [&](int i) {
+    return map.find_right(i + static_cast<int>(n)) != map.end_right();
+  });
+
+  if (!slow_inserts) {
+    // each miss inserts the missing key with the right key 0, erasing the pair that held it
+    std::size_t ops = std::min<std::size_t>(n, 10'000);
+    report(backend, n, "at_left_or_default", measure([&] { return Map(map); }, [&](Map& copy) {
+      std::size_t total = 0;
+      for (std::size_t i = 0; i < ops; ++i) {
+        int key = k.shuffled[i];
+        total += static_cast<std::size_t>(copy.at_left_or_default(i % 2 == 0 ? 2 * key : 2 * key + 1));
+      }
+      sink = sink + total;
+      return ops;
+    }));
+  }
+
+  // the middle half of the left order; iterators are found before the clock starts
+  report(backend, n, "erase range", measure([&] { return Map(map); }, [&](Map& copy) {
+    auto first = std::next(copy.begin_left(), static_cast<std::ptrdiff_t>(n / 4));
+    auto last = std::next(first, static_cast<std::ptrdiff_t>(n / 2));
+    copy.erase_left(first, last);
+    sink = sink + copy.size();
+    return n / 2;
+  }));
+
+  report(backend, n, "copy", measure(none, [&](int) {
+    Map copy(map);
+    sink = sink + copy.size();
+    return n;
+  }));
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  std::size_t max_size = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 10'000'000;
+
+  std::printf("%-10s %10s %-22s %12s %12s\n", "backend", "size", "case", "ns/op", "allocs/op");
+  for (std::size_t n = 1'000; n <= max_size; n *= 10) {
+    keys k(n);
+    run<bimap<int, int>>("rb", n, k, false);
+    run<bimap<int, int, std::less<int>, std::less<int>, bimap_components::btree_storage<>>>("btree", n, k, false);
+    run<flat_bimap<int, int>>("flat", n, k, true);
+    run<unordered_bimap<int, int>>("unordered", n, k, false);
+  }
+}
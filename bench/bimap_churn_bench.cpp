@@ -0,0 +1,152 @@
+// insert and erase churn on bimaps whose nodes come from std::allocator or from pool_allocator.
+//   g++ -std=c++20 -O2 bench/bimap_churn_bench.cpp -o bimap_churn_bench
+//   ./bimap_churn_bench [max size]
+// sizes go from 1K up to max size (1M by default) in steps of 10. every churn op erases a random
+// live pair and inserts a fresh one, so the size stays put; one op is counted per replaced pair.
+// find after churn looks up every live key of the churned map, where the nodes the global
+// allocator handed out are scattered across the heap
+
+#include "../bimap/bimap.h"
+#include "../bimap/pool-allocator.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <new>
+#include <numeric>
+#include <random>
+#include <utility>
+#include <vector>
+
+namespace {
+
+std::size_t allocations = 0;
+
+} // namespace
+
+// out of line, so the compiler does not pair the malloc behind new with a sized delete
+[[gnu::noinline]] void* operator new(std::size_t size) {
+  ++allocations;
+  if (void* p = std::malloc(size != 0 ? size : 1)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+[[gnu::noinline]] void operator delete(void* p) noexcept {
+  std::free(p);
+}
+
+[[gnu::noinline]] void operator delete(void* p, std::size_t) noexcept {
+  std::free(p);
+}
+
+namespace {
+
+using clock_type = std::chrono::steady_clock;
+
+// every case is repeated until it has done this many operations or run for MAX_SECONDS
+constexpr std::size_t MIN_OPS = 1 << 20;
+
+constexpr double MAX_SECONDS = 0.5;
+
+template <typename Storage, typename Allocator>
+using churn_bimap = bimap<int, int, std::less<int>, std::less<int>, Storage, Allocator>;
+
+struct measurement {
+  double seconds = 0;
+  std::size_t allocations = 0;
+  std::size_t ops = 0;
+};
+
+void report(const char* backend, const char* allocator, std::size_t n, const char* name, const measurement& m) {
+  double ops = static_cast<double>(m.ops);
+  std::printf(
+      "%-6s %-15s %10zu %-16s %12.1f %12.3f\n", backend, allocator, n, name, m.seconds * 1e9 / ops,
+      static_cast<double>(m.allocations) / ops
+  );
+}
+
+// calls setup and then the timed body, which returns the number of operations it did
+template <typename Setup, typename Body>
+measurement measure(Setup setup, Body body) {
+  measurement res;
+  while (res.ops < MIN_OPS && res.seconds < MAX_SECONDS) {
+    auto state = setup();
+    std::size_t before = allocations;
+    auto begin = clock_type::now();
+    res.ops += body(state);
+    res.seconds += std::chrono::duration<double>(clock_type::now() - begin).count();
+    res.allocations += allocations - before;
+  }
+  return res;
+}
+
+// a map of n pairs together with its live keys, filled in random order
+template <typename Map>
+struct churn_state {
+  explicit churn_state(std::size_t n) : live(n), next(static_cast<int>(n)) {
+    std::iota(live.begin(), live.end(), 0);
+    std::shuffle(live.begin(), live.end(), std::mt19937_64(n));
+    for (int key : live) {
+      map.insert(key, key);
+    }
+  }
+
+  Map map;
+  std::vector<int> live;
+  int next;
+};
+
+template <typename Map>
+void run(const char* backend, const char* allocator, std::size_t n) {
+  volatile std::size_t sink = 0;
+  std::mt19937_64 rng(n);
+
+  report(backend, allocator, n, "churn", measure([&] { return churn_state<Map>(n); }, [&](churn_state<Map>& s) {
+    for (std::size_t i = 0; i < n; ++i) {
+      int& slot = s.live[rng() % n];
+      s.map.erase_left(slot);
+      slot = s.next++;
+      s.map.insert(slot, slot);
+    }
+    sink = sink + s.map.size();
+    return n;
+  }));
+
+  churn_state<Map> churned(n);
+  for (std::size_t i = 0; i < n; ++i) {
+    int& slot = churned.live[rng() % n];
+    churned.map.erase_left(slot);
+    slot = churned.next++;
+    churned.map.insert(slot, slot);
+  }
+  std::shuffle(churned.live.begin(), churned.live.end(), rng);
+  report(backend, allocator, n, "find after churn", measure([] { return 0; }, [&](int) {
+    std::size_t found = 0;
+    for (int key : churned.live) {
+      found += churned.map.find_left(key) != churned.map.end_left();
+    }
+    sink = sink + found;
+    return n;
+  }));
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  using bimap_components::btree_storage;
+  using bimap_components::rb_tree_storage;
+  std::size_t max_size = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1'000'000;
+
+  std::printf("%-6s %-15s %10s %-16s %12s %12s\n", "tree", "allocator", "size", "case", "ns/op", "allocs/op");
+  for (std::size_t n = 1'000; n <= max_size; n *= 10) {
+    run<churn_bimap<rb_tree_storage, std::allocator<std::pair<int, int>>>>("rb", "std::allocator", n);
+    run<churn_bimap<rb_tree_storage, pool_allocator<std::pair<int, int>>>>("rb", "pool_allocator", n);
+    run<churn_bimap<btree_storage<>, std::allocator<std::pair<int, int>>>>("btree", "std::allocator", n);
+    run<churn_bimap<btree_storage<>, pool_allocator<std::pair<int, int>>>>("btree", "pool_allocator", n);
+  }
+}
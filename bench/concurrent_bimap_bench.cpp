@@ -0,0 +1,126 @@
+// read throughput of concurrent_bimap against a mutex-wrapped bimap, 1 to 64 reader threads
+// and one writer adding a new key and dropping the oldest one in a loop.
+//   g++ -std=c++20 -O2 -pthread bench/concurrent_bimap_bench.cpp -o concurrent_bimap_bench
+//   ./concurrent_bimap_bench [size] [milliseconds per run]
+
+#include "../bimap/concurrent-bimap.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using clock_type = std::chrono::steady_clock;
+
+struct result {
+  double reads_per_sec;
+  double writes_per_sec;
+};
+
+// the writer adds a new key and drops the oldest one, so the table keeps its size;
+// every run starts from a fresh table of keys [0, size)
+template <typename Find, typename Insert, typename Erase>
+result run(std::size_t threads, std::size_t size, int millis, Find find, Insert insert, Erase erase) {
+  std::atomic<bool> start{false};
+  std::atomic<bool> stop{false};
+  std::atomic<std::size_t> found_total{0};
+  std::vector<std::size_t> reads(threads);
+  std::size_t writes = 0;
+
+  std::vector<std::thread> readers;
+  for (std::size_t t = 0; t < threads; ++t) {
+    readers.emplace_back([&, t] {
+      std::mt19937_64 rng(t + 1);
+      std::size_t count = 0;
+      std::size_t found = 0;
+      while (!start.load(std::memory_order_acquire)) {
+      }
+      while (!stop.load(std::memory_order_relaxed)) {
+        for (int i = 0; i < 64; ++i) {
+          found += find(static_cast<int>(rng() % size));
+        }
+        count += 64;
+      }
+      reads[t] = count;
+      found_total.fetch_add(found, std::memory_order_relaxed);
+    });
+  }
+  std::thread writer([&] {
+    while (!start.load(std::memory_order_acquire)) {
+    }
+    int oldest = 0;
+    while (!stop.load(std::memory_order_relaxed)) {
+      insert(oldest + static_cast<int>(size), -oldest - static_cast<int>(size));
+      erase(oldest);
+      writes += 2;
+      ++oldest;
+    }
+  });
+
+  auto begin = clock_type::now();
+  start.store(true, std::memory_order_release);
+  std::this_thread::sleep_for(std::chrono::milliseconds(millis));
+  stop.store(true);
+  for (std::thread& reader : readers) {
+    reader.join();
+  }
+  writer.join();
+  double seconds = std::chrono::duration<double>(clock_type::now() - begin).count();
+
+  std::size_t total = 0;
+  for (std::size_t r : reads) {
+    total += r;
+  }
+  return {static_cast<double>(total) / seconds, static_cast<double>(writes) / seconds};
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  std::size_t size = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1'000'000;
+  int millis = argc > 2 ? std::atoi(argv[2]) : 1000;
+
+  bimap<int, int> initial;
+  for (std::size_t i = 0; i < size; ++i) {
+    initial.insert(static_cast<int>(i), -static_cast<int>(i));
+  }
+
+  std::printf("size %zu, %d ms per run, %u hardware threads\n", size, millis, std::thread::hardware_concurrency());
+  std::printf("%8s %18s %18s %18s %18s\n", "readers", "concurrent reads/s", "concurrent writes/s", "mutex reads/s",
+              "mutex writes/s");
+  for (std::size_t threads = 1; threads <= 64; threads *= 2) {
+    concurrent_bimap<int, int> shared(initial);
+    bimap<int, int> plain(initial);
+    std::mutex mutex;
+    result lock_free = run(
+        threads, size, millis,
+        [&](int key) -> std::size_t { return shared.find_left(key).has_value(); },
+        [&](int l, int r) { shared.insert(l, r); },
+        [&](int l) { shared.erase_left(l); }
+    );
+    result locked = run(
+        threads, size, millis,
+        [&](int key) -> std::size_t {
+          std::lock_guard<std::mutex> lock(mutex);
+          return plain.find_left(key) != plain.end_left();
+        },
+        [&](int l, int r) {
+          std::lock_guard<std::mutex> lock(mutex);
+          plain.insert(l, r);
+        },
+        [&](int l) {
+          std::lock_guard<std::mutex> lock(mutex);
+          plain.erase_left(l);
+        }
+    );
+    std::printf("%8zu %18.3e %18.3e %18.3e %18.3e\n", threads, lock_free.reads_per_sec, lock_free.writes_per_sec,
+                locked.reads_per_sec, locked.writes_per_sec);
+  }
+}
@@ -0,0 +1,277 @@
+// vector, socow_vector and std::vector over push_back, insert and erase in the middle, copy,
+// copy then mutate and iteration, with int and std::string elements.
+//   g++ -std=c++20 -O2 bench/container_bench.cpp -o container_bench
+//   ./container_bench [max size]
+// sizes go from 1 up to max size (10M by default) in steps of 10. every container, element type
+// and size runs in its own process, so the reported peak RSS belongs to that row group alone.
+// ns/op and allocs/op are per element, except for insert and erase, where they are per call;
+// those start from a container of the given size and do at most MIDDLE_OPS calls
+
+#include "../socow-vector/socow-vector.h"
+#include "../vector/vector.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace {
+
+std::size_t allocations = 0;
+
+} // namespace
+
+// vector keeps trivially copyable elements in malloc and realloc storage, which operator new
+// never sees, so on glibc those are counted too
+#ifdef __GLIBC__
+extern "C" {
+
+void* __libc_malloc(std::size_t size) noexcept;
+void* __libc_calloc(std::size_t count, std::size_t size) noexcept;
+void* __libc_realloc(void* p, std::size_t size) noexcept;
+void __libc_free(void* p) noexcept;
+
+void* malloc(std::size_t size) noexcept {
+  ++allocations;
+  return __libc_malloc(size);
+}
+
+void* calloc(std::size_t count, std::size_t size) noexcept {
+  ++allocations;
+  return __libc_calloc(count, size);
+}
+
+void* realloc(void* p, std::size_t size) noexcept {
+  ++allocations;
+  return __libc_realloc(p, size);
+}
+
+void free(void* p) noexcept {
+  __libc_free(p);
+}
+
+} // extern "C"
+
+namespace {
+
+void* raw_malloc(std::size_t size) noexcept {
+  return __libc_malloc(size);
+}
+
+void raw_free(void* p) noexcept {
+  __libc_free(p);
+}
+
+} // namespace
+#else
+namespace {
+
+void* raw_malloc(std::size_t size) noexcept {
+  return std::malloc(size);
+}
+
+void raw_free(void* p) noexcept {
+  std::free(p);
+}
+
+} // namespace
+#endif
+
+// out of line, so the compiler does not pair the malloc behind new with a sized delete
+[[gnu::noinline]] void* operator new(std::size_t size) {
+  ++allocations;
+  if (void* p = raw_malloc(size != 0 ? size : 1)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+[[gnu::noinline]] void operator delete(void* p) noexcept {
+  raw_free(p);
+}
+
+[[gnu::noinline]] void operator delete(void* p, std::size_t) noexcept {
+  raw_free(p);
+}
+
+namespace {
+
+using clock_type = std::chrono::steady_clock;
+
+// every case is repeated until it has done this many operations or run for MAX_SECONDS
+constexpr std::size_t MIN_OPS = 1 << 20;
+
+constexpr double MAX_SECONDS = 0.5;
+
+constexpr std::size_t MIDDLE_OPS = 1'000;
+
+// longer than the small string buffer, so every string owns a heap block
+template <typename T>
+T make(std::size_t i) {
+  if constexpr (std::is_same_v<T, std::string>) {
+    return std::string(32, static_cast<char>('a' + i % 26));
+  } else {
+    return static_cast<T>(i);
+  }
+}
+
+template <typename T>
+std::size_t weigh(const T& value) {
+  if constexpr (std::is_same_v<T, std::string>) {
+    return value.size();
+  } else {
+    return static_cast<std::size_t>(value);
+  }
+}
+
+struct measurement {
+  double seconds = 0;
+  std::size_t allocations = 0;
+  std::size_t ops = 0;
+};
+
+// calls setup and then the timed body, which returns the number of operations it did
+template <typename Setup, typename Body>
+measurement measure(Setup setup, Body body) {
+  measurement res;
+  while (res.ops < MIN_OPS && res.seconds < MAX_SECONDS) {
+    auto state = setup();
+    std::size_t before = allocations;
+    auto begin = clock_type::now();
+    res.ops += body(state);
+    res.seconds += std::chrono::duration<double>(clock_type::now() - begin).count();
+    res.allocations += allocations - before;
+  }
+  return res;
+}
+
+long peak_rss_kb() {
+  rusage usage{};
+  getrusage(RUSAGE_SELF, &usage);
+  return usage.ru_maxrss;
+}
+
+template <typename C, typename T>
+C filled(std::size_t n) {
+  C res;
+  for (std::size_t i = 0; i < n; ++i) {
+    res.push_back(make<T>(i));
+  }
+  return res;
+}
+
+template <typename C, typename T>
+void run(const char* container, const char* type, std::size_t n) {
+  volatile std::size_t sink = 0;
+  auto report = [&](const char* name, const measurement& m) {
+    double ops = static_cast<double>(m.ops);
+    std::printf(
+        "%-12s %-7s %10zu %-18s %12.1f %10.3f %12ld\n", container, type, n, name, m.seconds * 1e9 / ops,
+        static_cast<double>(m.allocations) / ops, peak_rss_kb()
+    );
+  };
+  auto none = [] { return 0; };
+  auto full = [&] { return filled<C, T>(n); };
+  std::size_t middle_ops = std::min(n, MIDDLE_OPS);
+
+  report("push_back", measure(none, [&](int) {
+    C c;
+    for (std::size_t i = 0; i < n; ++i) {
+      c.push_back(make<T>(i));
+    }
+    sink = sink + c.size();
+    return n;
+  }));
+
+  report("insert middle", measure(full, [&](C& c) {
+    for (std::size_t i = 0; i < middle_ops; ++i) {
+      c.insert(c.begin() + static_cast<std::ptrdiff_t>(c.size() / 2), make<T>(i));
+    }
+    sink = sink + c.size();
+    return middle_ops;
+  }));
+
+  report("erase middle", measure(full, [&](C& c) {
+    for (std::size_t i = 0; i < middle_ops; ++i) {
+      c.erase(c.begin() + static_cast<std::ptrdiff_t>(c.size() / 2));
+    }
+    sink = sink + c.size();
+    return middle_ops;
+  }));
+
+  const C source = filled<C, T>(n);
+  report("copy", measure(none, [&](int) {
+    C copy(source);
+    sink = sink + copy.size();
+    return n;
+  }));
+
+  // socow_vector shares the buffer on copy and pays for it on the first write
+  report("copy then mutate", measure(none, [&](int) {
+    C copy(source);
+    copy[n / 2] = make<T>(n);
+    sink = sink + copy.size();
+    return n;
+  }));
+
+  report("iterate", measure(none, [&](int) {
+    std::size_t total = 0;
+    for (const T& value : source) {
+      total += weigh(value);
+    }
+    sink = sink + total;
+    return n;
+  }));
+}
+
+// forks, so that the peak RSS of the child covers this run only
+template <typename C, typename T>
+void run_isolated(const char* container, const char* type, std::size_t n) {
+  std::fflush(stdout);
+  pid_t pid = fork();
+  if (pid == 0) {
+    run<C, T>(container, type, n);
+    std::fflush(stdout);
+    _exit(0);
+  }
+  if (pid < 0) {
+    run<C, T>(container, type, n);
+    return;
+  }
+  int status = 0;
+  waitpid(pid, &status, 0);
+  if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+    std::printf("%-12s %-7s %10zu failed\n", container, type, n);
+  }
+}
+
+template <typename T>
+void run_all(const char* type, std::size_t n) {
+  run_isolated<vector<T>, T>("vector", type, n);
+  run_isolated<socow_vector<T, 3>, T>("socow_vector", type, n);
+  run_isolated<std::vector<T>, T>("std::vector", type, n);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  std::size_t max_size = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 10'000'000;
+
+  std::printf(
+      "%-12s %-7s %10s %-18s %12s %10s %12s\n", "container", "type", "size", "case", "ns/op", "allocs/op",
+      "peak RSS KB"
+  );
+  for (std::size_t n = 1; n <= max_size; n *= 10) {
+    run_all<int>("int", n);
+    run_all<std::string>("string", n);
+  }
+}
@@ -0,0 +1,112 @@
+// square matrix products through the packed kernel of matrix-gemm.h against the inner_product
+// over column iterators that operator* used before.
+//   g++ -std=c++20 -O2 bench/matrix_gemm_bench.cpp -o matrix_gemm_bench
+//   ./matrix_gemm_bench [max size] [max old size]
+// sizes go from 64 up to max size (4096 by default) in steps of 2; the old product stops after
+// max old size (4096 by default as well, which takes tens of minutes). seconds are per product,
+// max diff is the largest difference between the two results
+
+#include "../matrix/matrix.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <numeric>
+
+namespace {
+
+using clock_type = std::chrono::steady_clock;
+
+// small products are repeated until they have run for this long
+constexpr double MIN_SECONDS = 0.5;
+
+template <typename T>
+matrix<T> make(std::size_t n, std::size_t seed) {
+  matrix<T> m(n, n);
+  for (std::size_t i = 0; i < m.size(); ++i) {
+    m.data()[i] = static_cast<T>(static_cast<double>((i * 7 + seed) % 19) / 8.0 - 1.0);
+  }
+  return m;
+}
+
+// the product as operator* computed it before the packed kernel
+template <typename T>
+matrix<T> old_product(const matrix<T>& left, const matrix<T>& right) {
+  matrix<T> res(left.rows(), right.cols());
+  for (std::size_t row = 0; row < left.rows(); ++row) {
+    for (std::size_t col = 0; col < right.cols(); ++col) {
+      res(row, col) = std::inner_product(left.row_begin(row), left.row_end(row), right.col_begin(col), T());
+    }
+  }
+  return res;
+}
+
+// seconds per call of product, which returns the result matrix
+template <typename Product>
+auto measure(Product product, double& seconds) {
+  std::size_t runs = 0;
+  double total = 0;
+  auto res = product();
+  do {
+    auto begin = clock_type::now();
+    res = product();
+    total += std::chrono::duration<double>(clock_type::now() - begin).count();
+    ++runs;
+  } while (total < MIN_SECONDS);
+  seconds = total / static_cast<double>(runs);
+  return res;
+}
+
+template <typename T>
+void run(const char* type, std::size_t n, bool old) {
+  matrix<T> a = make<T>(n, 1);
+  matrix<T> b = make<T>(n, 2);
+  double flops = 2.0 * static_cast<double>(n) * static_cast<double>(n) * static_cast<double>(n);
+
+  double new_seconds = 0;
+  matrix<T> fast = measure([&] { return matrix<T>(a * b); }, new_seconds);
+  if (!old) {
+    std::printf(
+        "%-7s %6zu %12.5f %10.2f %12s %10s %10s %10s\n", type, n, new_seconds, flops / new_seconds * 1e-9, "skipped",
+        "", "", ""
+    );
+    return;
+  }
+
+  double old_seconds = 0;
+  matrix<T> slow = n <= 1024 ? measure([&] { return old_product(a, b); }, old_seconds) : [&] {
+    auto begin = clock_type::now();
+    matrix<T> res = old_product(a, b);
+    old_seconds = std::chrono::duration<double>(clock_type::now() - begin).count();
+    return res;
+  }();
+  double diff = 0;
+  for (std::size_t i = 0; i < fast.size(); ++i) {
+    diff = std::max(diff, std::abs(static_cast<double>(fast.data()[i]) - static_cast<double>(slow.data()[i])));
+  }
+  std::printf(
+      "%-7s %6zu %12.5f %10.2f %12.5f %10.2f %10.1f %10.2g\n", type, n, new_seconds, flops / new_seconds * 1e-9,
+      old_seconds, flops / old_seconds * 1e-9, old_seconds / new_seconds, diff
+  );
+  std::fflush(stdout);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  std::size_t max_size = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 4096;
+  std::size_t max_old_size = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 4096;
+
+  std::printf(
+      "%-7s %6s %12s %10s %12s %10s %10s %10s\n", "type", "size", "new s", "GFLOPS", "old s", "GFLOPS", "speedup",
+      "max diff"
+  );
+  for (std::size_t n = 64; n <= max_size; n *= 2) {
+    run<double>("double", n, n <= max_old_size);
+    run<float>("float", n, n <= max_old_size);
+    run<int>("int", n, n <= max_old_size);
+  }
+}
@@ -0,0 +1,103 @@
+// thread scaling of the policy overloads of matrix-parallel.h on square matrices of doubles.
+//   g++ -std=c++20 -O2 -pthread bench/matrix_parallel_bench.cpp -o matrix_parallel_bench
+//   ./matrix_parallel_bench [max threads] [size]
+// threads go from 1 up to max threads (hardware_concurrency by default), size is 4096 by default.
+// seconds are per call, speedup is against one thread, max diff compares each product with the
+// one computed by a single thread
+
+#include "../matrix/matrix.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <utility>
+
+namespace {
+
+using clock_type = std::chrono::steady_clock;
+using matrix_parallel::parallel_policy;
+
+// element-wise operations are repeated until they have run for this long
+constexpr double MIN_SECONDS = 0.5;
+
+matrix<double> make(std::size_t n, std::size_t seed) {
+  matrix<double> m(n, n);
+  for (std::size_t i = 0; i < m.size(); ++i) {
+    m.data()[i] = static_cast<double>((i * 7 + seed) % 19) / 8.0 - 1.0;
+  }
+  return m;
+}
+
+template <typename Operation>
+double measure(Operation operation) {
+  std::size_t runs = 0;
+  double total = 0;
+  operation();
+  do {
+    auto begin = clock_type::now();
+    operation();
+    total += std::chrono::duration<double>(clock_type::now() - begin).count();
+    ++runs;
+  } while (total < MIN_SECONDS);
+  return total / static_cast<double>(runs);
+}
+
+struct measurement {
+  double add;
+  double subtract;
+  double scale;
+  double multiply;
+};
+
+} // namespace
+
+int main(int argc, char** argv) {
+  std::size_t max_threads = argc > 1 ? std::strtoull(argv[1], nullptr, 10)
+                                     : std::max<std::size_t>(1, std::thread::hardware_concurrency());
+  std::size_t n = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 4096;
+
+  matrix<double> a = make(n, 1);
+  matrix<double> b = make(n, 2);
+  // the element-wise operations work on their own copy, so that the products always see a
+  matrix<double> c = a;
+  matrix<double> reference;
+  measurement single{};
+  double flops = 2.0 * static_cast<double>(n) * static_cast<double>(n) * static_cast<double>(n);
+
+  std::printf("%zux%zu doubles, %u hardware threads\n", n, n, std::thread::hardware_concurrency());
+  std::printf(
+      "%7s %10s %8s %10s %8s %10s %8s %11s %8s %8s %9s\n", "threads", "add s", "speedup", "sub s", "speedup",
+      "scale s", "speedup", "multiply s", "GFLOPS", "speedup", "max diff"
+  );
+  for (std::size_t threads = 1; threads <= max_threads; ++threads) {
+    parallel_policy policy{threads};
+    measurement m{};
+    m.add = measure([&] { c.add(b, policy); });
+    m.subtract = measure([&] { c.subtract(b, policy); });
+    m.scale = measure([&] { c.scale(-1.0, policy); });
+
+    auto begin = clock_type::now();
+    matrix<double> product = multiply(a, b, policy);
+    m.multiply = std::chrono::duration<double>(clock_type::now() - begin).count();
+
+    double diff = 0;
+    if (threads == 1) {
+      single = m;
+      reference = std::move(product);
+    } else {
+      for (std::size_t i = 0; i < reference.size(); ++i) {
+        diff = std::max(diff, std::abs(product.data()[i] - reference.data()[i]));
+      }
+    }
+    std::printf(
+        "%7zu %10.5f %8.2f %10.5f %8.2f %10.5f %8.2f %11.3f %8.2f %8.2f %9.2g\n", threads, m.add,
+        single.add / m.add, m.subtract, single.subtract / m.subtract, m.scale, single.scale / m.scale, m.multiply,
+        flops / m.multiply * 1e-9, single.multiply / m.multiply, diff
+    );
+    std::fflush(stdout);
+  }
+}
@@ -0,0 +1,137 @@
+// iteration over an array of short vectors: socow_vector with a hand-picked inline capacity,
+// compact_socow_vector filling one cache line, the same 64 bytes without cache line alignment
+// and std::vector.
+//   g++ -std=c++20 -O2 bench/socow_array_bench.cpp -o socow_array_bench
+//   ./socow_array_bench [vectors]
+// the array holds that many vectors (1M by default), each of the given length. ns/op is per
+// element read, fill allocs/v is the number of allocations push_back made per vector
+
+#include "../socow-vector/socow-vector.h"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <initializer_list>
+#include <new>
+#include <vector>
+
+namespace {
+
+std::size_t allocations = 0;
+
+} // namespace
+
+// out of line, so the compiler does not pair the malloc behind new with a sized delete
+[[gnu::noinline]] void* operator new(std::size_t size) {
+  ++allocations;
+  if (void* p = std::malloc(size != 0 ? size : 1)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+[[gnu::noinline]] void* operator new(std::size_t size, std::align_val_t align) {
+  ++allocations;
+  std::size_t alignment = static_cast<std::size_t>(align);
+  if (void* p = std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+[[gnu::noinline]] void operator delete(void* p) noexcept {
+  std::free(p);
+}
+
+[[gnu::noinline]] void operator delete(void* p, std::size_t) noexcept {
+  std::free(p);
+}
+
+[[gnu::noinline]] void operator delete(void* p, std::align_val_t) noexcept {
+  std::free(p);
+}
+
+[[gnu::noinline]] void operator delete(void* p, std::size_t, std::align_val_t) noexcept {
+  std::free(p);
+}
+
+namespace {
+
+using clock_type = std::chrono::steady_clock;
+
+// every case is repeated until it has done this many operations or run for MAX_SECONDS
+constexpr std::size_t MIN_OPS = 1 << 24;
+
+constexpr double MAX_SECONDS = 0.5;
+
+constexpr std::size_t LINE_INTS = socow_components::inline_capacity<int, socow_components::CACHE_LINE>;
+
+using compact = compact_socow_vector<int>;
+
+// as large as compact, but aligned to its size field only
+using unaligned = socow_vector<int, LINE_INTS>;
+
+static_assert(sizeof(unaligned) == sizeof(compact) && alignof(unaligned) < alignof(compact));
+
+struct measurement {
+  double seconds = 0;
+  std::size_t ops = 0;
+};
+
+// repeats the timed body, which returns the number of operations it did
+template <typename Body>
+measurement measure(Body body) {
+  measurement res;
+  while (res.ops < MIN_OPS && res.seconds < MAX_SECONDS) {
+    auto begin = clock_type::now();
+    res.ops += body();
+    res.seconds += std::chrono::duration<double>(clock_type::now() - begin).count();
+  }
+  return res;
+}
+
+template <typename V>
+void run(const char* container, std::size_t count, std::size_t length) {
+  volatile std::size_t sink = 0;
+  // malloc aligns to 16 bytes only, so the unaligned vectors straddle two lines each
+  std::vector<V> vectors(count);
+  std::size_t before = allocations;
+  for (V& v : vectors) {
+    for (std::size_t i = 0; i < length; ++i) {
+      v.push_back(static_cast<int>(i));
+    }
+  }
+  double fill_allocations = static_cast<double>(allocations - before) / static_cast<double>(count);
+
+  measurement m = measure([&] {
+    std::size_t total = 0;
+    for (const V& v : vectors) {
+      for (int value : v) {
+        total += static_cast<std::size_t>(value);
+      }
+    }
+    sink = sink + total;
+    return count * length;
+  });
+  std::printf(
+      "%-22s %8zu %10zu %6zu %12.3f %14.3f\n", container, sizeof(V), count, length,
+      m.seconds * 1e9 / static_cast<double>(m.ops), fill_allocations
+  );
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  std::size_t count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1'000'000;
+
+  std::printf(
+      "%-22s %8s %10s %6s %12s %14s\n", "container", "sizeof", "vectors", "length", "ns/op", "fill allocs/v"
+  );
+  for (std::size_t length : {std::size_t(2), std::size_t(8), LINE_INTS, 2 * LINE_INTS}) {
+    run<socow_vector<int, 3>>("socow_vector<int, 3>", count, length);
+    run<compact>("compact_socow_vector", count, length);
+    run<unaligned>("unaligned 64 bytes", count, length);
+    run<std::vector<int>>("std::vector", count, length);
+  }
+}
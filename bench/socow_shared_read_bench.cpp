@@ -0,0 +1,157 @@
+// reading a socow_vector that shares its buffer with another copy, through the read-only
+// accessors and through the mutable ones that unshare it first.
+//   g++ -std=c++20 -O2 bench/socow_shared_read_bench.cpp -o socow_shared_read_bench
+//   ./socow_shared_read_bench [size]
+// the vector holds size elements (1M by default) and every pass starts from a fresh copy of it.
+// ns/op is per element, allocs/pass counts the allocations of one whole pass
+
+#include "../socow-vector/socow-vector.h"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+namespace {
+
+std::size_t allocations = 0;
+
+} // namespace
+
+// out of line, so the compiler does not pair the malloc behind new with a sized delete
+[[gnu::noinline]] void* operator new(std::size_t size) {
+  ++allocations;
+  if (void* p = std::malloc(size != 0 ? size : 1)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+[[gnu::noinline]] void operator delete(void* p) noexcept {
+  std::free(p);
+}
+
+[[gnu::noinline]] void operator delete(void* p, std::size_t) noexcept {
+  std::free(p);
+}
+
+namespace {
+
+using clock_type = std::chrono::steady_clock;
+
+// every case is repeated until it has done this many operations or run for MAX_SECONDS
+constexpr std::size_t MIN_OPS = 1 << 24;
+
+constexpr double MAX_SECONDS = 0.5;
+
+// longer than the small string buffer, so every string owns a heap block
+template <typename T>
+T make(std::size_t i) {
+  if constexpr (std::is_same_v<T, std::string>) {
+    return std::string(32, static_cast<char>('a' + i % 26));
+  } else {
+    return static_cast<T>(i);
+  }
+}
+
+template <typename T>
+std::size_t weigh(const T& value) {
+  if constexpr (std::is_same_v<T, std::string>) {
+    return value.size();
+  } else {
+    return static_cast<std::size_t>(value);
+  }
+}
+
+struct measurement {
+  double seconds = 0;
+  std::size_t allocations = 0;
+  std::size_t ops = 0;
+  std::size_t passes = 0;
+};
+
+// calls setup and then the timed body, which returns the number of operations it did
+template <typename Setup, typename Body>
+measurement measure(Setup setup, Body body) {
+  measurement res;
+  while (res.ops < MIN_OPS && res.seconds < MAX_SECONDS) {
+    auto state = setup();
+    std::size_t before = allocations;
+    auto begin = clock_type::now();
+    res.ops += body(state);
+    res.seconds += std::chrono::duration<double>(clock_type::now() - begin).count();
+    res.allocations += allocations - before;
+    ++res.passes;
+  }
+  return res;
+}
+
+template <typename T>
+void run(const char* type, std::size_t n) {
+  using vec = socow_vector<T, 3>;
+  volatile std::size_t sink = 0;
+  auto report = [&](const char* name, const measurement& m) {
+    std::printf(
+        "%-7s %10zu %-22s %12.3f %12.3f\n", type, n, name, m.seconds * 1e9 / static_cast<double>(m.ops),
+        static_cast<double>(m.allocations) / static_cast<double>(m.passes)
+    );
+  };
+
+  vec source;
+  for (std::size_t i = 0; i < n; ++i) {
+    source.push_back(make<T>(i));
+  }
+  auto shared = [&] { return vec(source); };
+
+  report("cview", measure(shared, [&](vec& v) {
+    std::size_t total = 0;
+    for (const T& value : v.cview()) {
+      total += weigh(value);
+    }
+    sink = sink + total;
+    return n;
+  }));
+
+  report("cbegin, cend", measure(shared, [&](vec& v) {
+    std::size_t total = 0;
+    for (auto it = v.cbegin(); it != v.cend(); ++it) {
+      total += weigh(*it);
+    }
+    sink = sink + total;
+    return n;
+  }));
+
+  report("const operator[]", measure(shared, [&](vec& v) {
+    const vec& view = v;
+    std::size_t total = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+      total += weigh(view[i]);
+    }
+    sink = sink + total;
+    return n;
+  }));
+
+  // the first call unshares and copies every element
+  report("begin, end (unshares)", measure(shared, [&](vec& v) {
+    std::size_t total = 0;
+    for (auto it = v.begin(); it != v.end(); ++it) {
+      total += weigh(*it);
+    }
+    sink = sink + total;
+    return n;
+  }));
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  std::size_t size = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1'000'000;
+
+  std::printf("%-7s %10s %-22s %12s %12s\n", "type", "size", "case", "ns/op", "allocs/pass");
+  run<int>("int", size);
+  run<std::string>("string", size);
+}
@@ -0,0 +1,226 @@
+// push_back of int and std::string into vector, into the copy-on-grow vector it replaced and
+// into std::vector.
+//   g++ -std=c++20 -O2 bench/vector_push_back_bench.cpp -o vector_push_back_bench
+//   ./vector_push_back_bench [max size]
+// sizes go from 1 up to max size (10M by default) in steps of 10. ns/op and allocs/op are per
+// element; allocations of the strings themselves count too, so copies show up next to moves
+
+#include "../vector/vector.h"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <ratio>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace {
+
+std::size_t allocations = 0;
+
+} // namespace
+
+// vector keeps trivially copyable elements in malloc and realloc storage, which operator new
+// never sees, so on glibc those are counted too
+#ifdef __GLIBC__
+extern "C" {
+
+void* __libc_malloc(std::size_t size) noexcept;
+void* __libc_calloc(std::size_t count, std::size_t size) noexcept;
+void* __libc_realloc(void* p, std::size_t size) noexcept;
+void __libc_free(void* p) noexcept;
+
+void* malloc(std::size_t size) noexcept {
+  ++allocations;
+  return __libc_malloc(size);
+}
+
+void* calloc(std::size_t count, std::size_t size) noexcept {
+  ++allocations;
+  return __libc_calloc(count, size);
+}
+
+void* realloc(void* p, std::size_t size) noexcept {
+  ++allocations;
+  return __libc_realloc(p, size);
+}
+
+void free(void* p) noexcept {
+  __libc_free(p);
+}
+
+} // extern "C"
+
+namespace {
+
+void* raw_malloc(std::size_t size) noexcept {
+  return __libc_malloc(size);
+}
+
+void raw_free(void* p) noexcept {
+  __libc_free(p);
+}
+
+} // namespace
+#else
+namespace {
+
+void* raw_malloc(std::size_t size) noexcept {
+  return std::malloc(size);
+}
+
+void raw_free(void* p) noexcept {
+  std::free(p);
+}
+
+} // namespace
+#endif
+
+// out of line, so the compiler does not pair the malloc behind new with a sized delete
+[[gnu::noinline]] void* operator new(std::size_t size) {
+  ++allocations;
+  if (void* p = raw_malloc(size != 0 ? size : 1)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+[[gnu::noinline]] void operator delete(void* p) noexcept {
+  raw_free(p);
+}
+
+[[gnu::noinline]] void operator delete(void* p, std::size_t) noexcept {
+  raw_free(p);
+}
+
+namespace {
+
+using clock_type = std::chrono::steady_clock;
+
+// every case is repeated until it has done this many operations or run for MAX_SECONDS
+constexpr std::size_t MIN_OPS = 1 << 20;
+
+constexpr double MAX_SECONDS = 0.5;
+
+// the growth path vector had before: every reallocation goes through operator new and copies
+// each element into the new buffer, whatever its type
+template <typename T>
+class legacy_vector {
+public:
+  legacy_vector() = default;
+
+  legacy_vector(const legacy_vector&) = delete;
+  legacy_vector& operator=(const legacy_vector&) = delete;
+
+  ~legacy_vector() {
+    destroy(_data, _size);
+    operator delete(_data);
+  }
+
+  void push_back(T value) {
+    if (_size == _capacity) {
+      resize(2 * _capacity + 1);
+    }
+    new (_data + _size) T(std::move(value));
+    _size++;
+  }
+
+  size_t size() const noexcept {
+    return _size;
+  }
+
+private:
+  static void destroy(T* p, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+      p[count - i - 1].~T();
+    }
+  }
+
+  void resize(size_t new_capacity) {
+    T* new_data = static_cast<T*>(operator new(new_capacity * sizeof(T)));
+    for (size_t i = 0; i < _size; ++i) {
+      new (new_data + i) T(_data[i]);
+    }
+    destroy(_data, _size);
+    operator delete(_data);
+    _capacity = new_capacity;
+    _data = new_data;
+  }
+
+private:
+  T* _data = nullptr;
+  size_t _size = 0;
+  size_t _capacity = 0;
+};
+
+// longer than the small string buffer, so every string owns a heap block
+template <typename T>
+T make(std::size_t i) {
+  if constexpr (std::is_same_v<T, std::string>) {
+    return std::string(32, static_cast<char>('a' + i % 26));
+  } else {
+    return static_cast<T>(i);
+  }
+}
+
+struct measurement {
+  double seconds = 0;
+  std::size_t allocations = 0;
+  std::size_t ops = 0;
+};
+
+// repeats the timed body, which returns the number of operations it did
+template <typename Body>
+measurement measure(Body body) {
+  measurement res;
+  while (res.ops < MIN_OPS && res.seconds < MAX_SECONDS) {
+    std::size_t before = allocations;
+    auto begin = clock_type::now();
+    res.ops += body();
+    res.seconds += std::chrono::duration<double>(clock_type::now() - begin).count();
+    res.allocations += allocations - before;
+  }
+  return res;
+}
+
+template <typename C, typename T>
+void run(const char* container, const char* type, std::size_t n) {
+  volatile std::size_t sink = 0;
+  measurement m = measure([&] {
+    C c;
+    for (std::size_t i = 0; i < n; ++i) {
+      c.push_back(make<T>(i));
+    }
+    sink = sink + c.size();
+    return n;
+  });
+  double ops = static_cast<double>(m.ops);
+  std::printf(
+      "%-16s %-7s %10zu %12.1f %10.3f\n", container, type, n, m.seconds * 1e9 / ops,
+      static_cast<double>(m.allocations) / ops
+  );
+}
+
+template <typename T>
+void run_all(const char* type, std::size_t n) {
+  run<vector<T>, T>("vector", type, n);
+  run<vector<T, std::allocator<T>, std::ratio<3, 2>>, T>("vector 1.5x", type, n);
+  run<legacy_vector<T>, T>("copy-on-grow", type, n);
+  run<std::vector<T>, T>("std::vector", type, n);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  std::size_t max_size = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 10'000'000;
+
+  std::printf("%-16s %-7s %10s %12s %10s\n", "container", "type", "size", "ns/op", "allocs/op");
+  for (std::size_t n = 1; n <= max_size; n *= 10) {
+    run_all<int>("int", n);
+    run_all<std::string>("string", n);
+  }
+}
@@ -0,0 +1,224 @@
+// fill, find, count and == of vector<int32_t> and vector<float> against each kernel of vector-simd.h
+// and a loop the compiler must not vectorize.
+//   g++ -std=c++20 -O2 bench/vector_simd_bench.cpp -o vector_simd_bench
+//   ./vector_simd_bench [max size]
+// sizes go from 16 up to max size (2^20 by default) in steps of 16. ns/op is per element: find
+// looks for a missing value and == compares equal vectors, so both scan everything. the vector
+// rows go through the member functions and their runtime dispatch, the sse2 and avx2 rows call
+// the kernels directly and avx2 is skipped on processors without it
+
+#include "../vector/vector-simd.h"
+#include "../vector/vector.h"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+
+namespace {
+
+using clock_type = std::chrono::steady_clock;
+
+// every case is repeated until it has done this many operations or run for MAX_SECONDS
+constexpr std::size_t MIN_OPS = 1 << 24;
+
+constexpr double MAX_SECONDS = 0.5;
+
+// element by element, as vector did before
+struct scalar_kernels {
+  template <typename T>
+  [[gnu::noinline]] __attribute__((optimize("no-tree-vectorize"))) static void fill(T* data, std::size_t n, T value) {
+    for (std::size_t i = 0; i < n; ++i) {
+      data[i] = value;
+    }
+  }
+
+  template <typename T>
+  [[gnu::noinline]] __attribute__((optimize("no-tree-vectorize"))) static std::size_t find(
+      const T* data, std::size_t n, T value
+  ) {
+    for (std::size_t i = 0; i < n; ++i) {
+      if (data[i] == value) {
+        return i;
+      }
+    }
+    return n;
+  }
+
+  template <typename T>
+  [[gnu::noinline]] __attribute__((optimize("no-tree-vectorize"))) static std::size_t count(
+      const T* data, std::size_t n, T value
+  ) {
+    std::size_t res = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+      res += data[i] == value;
+    }
+    return res;
+  }
+
+  template <typename T>
+  [[gnu::noinline]] __attribute__((optimize("no-tree-vectorize"))) static bool equal(
+      const T* a, const T* b, std::size_t n
+  ) {
+    for (std::size_t i = 0; i < n; ++i) {
+      if (!(a[i] == b[i])) {
+        return false;
+      }
+    }
+    return true;
+  }
+};
+
+#if VECTOR_SIMD_X86
+struct sse2_kernels {
+  template <typename T>
+  [[gnu::noinline]] static void fill(T* data, std::size_t n, T value) {
+    vector_simd::lanes<T, 16>::fill(data, n, value);
+  }
+
+  template <typename T>
+  [[gnu::noinline]] static std::size_t find(const T* data, std::size_t n, T value) {
+    return vector_simd::lanes<T, 16>::find(data, n, value);
+  }
+
+  template <typename T>
+  [[gnu::noinline]] static std::size_t count(const T* data, std::size_t n, T value) {
+    return vector_simd::lanes<T, 16>::count(data, n, value);
+  }
+
+  template <typename T>
+  [[gnu::noinline]] static bool equal(const T* a, const T* b, std::size_t n) {
+    return vector_simd::lanes<T, 16>::equal(a, b, n);
+  }
+};
+
+struct avx2_kernels {
+  template <typename T>
+  static void fill(T* data, std::size_t n, T value) {
+    vector_simd::fill_avx2(data, n, value);
+  }
+
+  template <typename T>
+  static std::size_t find(const T* data, std::size_t n, T value) {
+    return vector_simd::find_avx2(data, n, value);
+  }
+
+  template <typename T>
+  static std::size_t count(const T* data, std::size_t n, T value) {
+    return vector_simd::count_avx2(data, n, value);
+  }
+
+  template <typename T>
+  static bool equal(const T* a, const T* b, std::size_t n) {
+    return vector_simd::equal_avx2(a, b, n);
+  }
+};
+#endif
+
+struct measurement {
+  double seconds = 0;
+  std::size_t ops = 0;
+};
+
+// repeats the timed body, which returns the number of operations it did
+template <typename Body>
+measurement measure(Body body) {
+  measurement res;
+  while (res.ops < MIN_OPS && res.seconds < MAX_SECONDS) {
+    auto begin = clock_type::now();
+    res.ops += body();
+    res.seconds += std::chrono::duration<double>(clock_type::now() - begin).count();
+  }
+  return res;
+}
+
+void report(const char* kernel, const char* type, std::size_t n, const char* name, const measurement& m) {
+  std::printf("%-8s %-7s %10zu %-6s %10.3f\n", kernel, type, n, name, m.seconds * 1e9 / static_cast<double>(m.ops));
+}
+
+// every seventh element is 3, no element is -1
+template <typename T>
+vector<T> make(std::size_t n) {
+  vector<T> res;
+  for (std::size_t i = 0; i < n; ++i) {
+    res.push_back(static_cast<T>(i % 7));
+  }
+  return res;
+}
+
+template <typename Kernels, typename T>
+void run(const char* kernel, const char* type, std::size_t n) {
+  volatile std::size_t sink = 0;
+  vector<T> a = make<T>(n);
+  const vector<T> b = a;
+
+  report(kernel, type, n, "fill", measure([&] {
+    Kernels::fill(a.data(), n, static_cast<T>(3));
+    sink = sink + static_cast<std::size_t>(a[n / 2]);
+    return n;
+  }));
+  a = b;
+  report(kernel, type, n, "find", measure([&] {
+    sink = sink + Kernels::find(b.data(), n, static_cast<T>(-1));
+    return n;
+  }));
+  report(kernel, type, n, "count", measure([&] {
+    sink = sink + Kernels::count(b.data(), n, static_cast<T>(3));
+    return n;
+  }));
+  report(kernel, type, n, "==", measure([&] {
+    sink = sink + Kernels::equal(a.data(), b.data(), n);
+    return n;
+  }));
+}
+
+template <typename T>
+void run_vector(const char* type, std::size_t n) {
+  volatile std::size_t sink = 0;
+  vector<T> a = make<T>(n);
+  const vector<T> b = a;
+
+  report("vector", type, n, "fill", measure([&] {
+    a.fill(static_cast<T>(3));
+    sink = sink + static_cast<std::size_t>(a[n / 2]);
+    return n;
+  }));
+  a = b;
+  report("vector", type, n, "find", measure([&] {
+    sink = sink + static_cast<std::size_t>(b.find(static_cast<T>(-1)) - b.begin());
+    return n;
+  }));
+  report("vector", type, n, "count", measure([&] {
+    sink = sink + b.count(static_cast<T>(3));
+    return n;
+  }));
+  report("vector", type, n, "==", measure([&] {
+    sink = sink + (a == b);
+    return n;
+  }));
+}
+
+template <typename T>
+void run_all(const char* type, std::size_t n) {
+  run<scalar_kernels, T>("scalar", type, n);
+#if VECTOR_SIMD_X86
+  run<sse2_kernels, T>("sse2", type, n);
+  if (vector_simd::has_avx2()) {
+    run<avx2_kernels, T>("avx2", type, n);
+  }
+#endif
+  run_vector<T>(type, n);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  std::size_t max_size = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : std::size_t(1) << 20;
+
+  std::printf("%-8s %-7s %10s %-6s %10s\n", "kernel", "type", "size", "case", "ns/op");
+  for (std::size_t n = 16; n <= max_size; n *= 16) {
+    run_all<std::int32_t>("int32_t", n);
+    run_all<float>("float", n);
+  }
+}
@@ -0,0 +1,322 @@
+#pragma once
+
+#include "nodes.h"
+
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+namespace bimap_components {
+
+// the public surface of bimap that does not depend on the storage; Derived supplies
+// base_insert (plain and hinted), erase_iterator<Tag> and at_other_or_default<Tag>
+// and keeps sz_ up to date, everything else is answered by the two index maps
+template <
+    typename Derived,
+    typename Left,
+    typename Right,
+    typename CompareLeft,
+    typename CompareRight,
+    typename Storage,
+    typename LeftMap,
+    typename RightMap>
+class bimap_base
+    : protected LeftMap
+    , protected RightMap {
+public:
+  using left_iterator = LeftMap::iterator;
+
+  using right_iterator = RightMap::iterator;
+
+protected:
+  template <typename Tag>
+  using tag_type_v = std::conditional_t<std::is_same_v<Tag, tag_left>, Left, Right>;
+
+  template <typename Tag>
+  using base_map_v = std::conditional_t<std::is_same_v<Tag, tag_left>, LeftMap, RightMap>;
+
+  // map_args are passed on to both index maps after the header and the comparator
+  template <typename Header, typename... MapArgs>
+  bimap_base(Header* header, CompareLeft compare_left, CompareRight compare_right, const MapArgs&... map_args)
+      : LeftMap(header, std::move(compare_left), map_args...)
+      , RightMap(header, std::move(compare_right), map_args...)
+      , sz_(0) {}
+
+  bimap_base(const bimap_base&) = delete;
+  bimap_base& operator=(const bimap_base&) = delete;
+
+  ~bimap_base() = default;
+
+private:
+  Derived& derived() noexcept {
+    return static_cast<Derived&>(*this);
+  }
+
+  template <typename Tag, typename K>
+  bool erase_value(const K& key) {
+    auto it = base_map_v<Tag>::find(key);
+    if (it == base_map_v<Tag>::end()) {
+      return false;
+    }
+    derived().template erase_iterator<Tag>(it);
+    return true;
+  }
+
+public:
+  left_iterator insert(const Left& left, const Right& right) {
+    return derived().base_insert(left, right);
+  }
+
+  left_iterator insert(const Left& left, Right&& right) {
+    return derived().base_insert(left, std::move(right));
+  }
+
+  left_iterator insert(Left&& left, const Right& right) {
+    return derived().base_insert(std::move(left), right);
+  }
+
+  left_iterator insert(Left&& left, Right&& right) {
+    return derived().base_insert(std::move(left), std::move(right));
+  }
+
+  // hint_left and hint_right are the elements the pair would be inserted before;
+  // how much a correct hint saves depends on the storage
+  left_iterator insert(left_iterator hint_left, right_iterator hint_right, const Left& left, const Right& right) {
+    return derived().base_insert(hint_left, hint_right, left, right);
+  }
+
+  left_iterator insert(left_iterator hint_left, right_iterator hint_right, const Left& left, Right&& right) {
+    return derived().base_insert(hint_left, hint_right, left, std::move(right));
+  }
+
+  left_iterator insert(left_iterator hint_left, right_iterator hint_right, Left&& left, const Right& right) {
+    return derived().base_insert(hint_left, hint_right, std::move(left), right);
+  }
+
+  left_iterator insert(left_iterator hint_left, right_iterator hint_right, Left&& left, Right&& right) {
+    return derived().base_insert(hint_left, hint_right, std::move(left), std::move(right));
+  }
+
+  left_iterator erase_left(left_iterator it) noexcept {
+    return derived().template erase_iterator<tag_left>(it);
+  }
+
+  right_iterator erase_right(right_iterator it) noexcept {
+    return derived().template erase_iterator<tag_right>(it);
+  }
+
+  bool erase_left(const Left& left) {
+    return erase_value<tag_left>(left);
+  }
+
+  template <typename K>
+    requires transparent<CompareLeft> && (!std::is_convertible_v<const K&, left_iterator>)
+  bool erase_left(const K& left) {
+    return erase_value<tag_left>(left);
+  }
+
+  bool erase_right(const Right& right) {
+    return erase_value<tag_right>(right);
+  }
+
+  template <typename K>
+    requires transparent<CompareRight> && (!std::is_convertible_v<const K&, right_iterator>)
+  bool erase_right(const K& right) {
+    return erase_value<tag_right>(right);
+  }
+
+  left_iterator erase_left(left_iterator first, left_iterator last) noexcept {
+    while (first != last) {
+      first = erase_left(first);
+    }
+    return last;
+  }
+
+  right_iterator erase_right(right_iterator first, right_iterator last) noexcept {
+    while (first != last) {
+      first = erase_right(first);
+    }
+    return last;
+  }
+
+  left_iterator find_left(const Left& left) const {
+    return LeftMap::find(left);
+  }
+
+  template <typename K>
+    requires transparent<CompareLeft>
+  left_iterator find_left(const K& left) const {
+    return LeftMap::find(left);
+  }
+
+  right_iterator find_right(const Right& right) const {
+    return RightMap::find(right);
+  }
+
+  template <typename K>
+    requires transparent<CompareRight>
+  right_iterator find_right(const K& right) const {
+    return RightMap::find(right);
+  }
+
+  const Right& at_left(const Left& key) const {
+    return LeftMap::at_other(key);
+  }
+
+  template <typename K>
+    requires transparent<CompareLeft>
+  const Right& at_left(const K& key) const {
+    return LeftMap::at_other(key);
+  }
+
+  const Left& at_right(const Right& key) const {
+    return RightMap::at_other(key);
+  }
+
+  template <typename K>
+    requires transparent<CompareRight>
+  const Left& at_right(const K& key) const {
+    return RightMap::at_other(key);
+  }
+
+  const Right& at_left_or_default(const Left& key)
+    requires std::is_default_constructible_v<Right>
+  {
+    return derived().template at_other_or_default<tag_left>(key);
+  }
+
+  const Left& at_right_or_default(const Right& key)
+    requires std::is_default_constructible_v<Left>
+  {
+    return derived().template at_other_or_default<tag_right>(key);
+  }
+
+  left_iterator lower_bound_left(const Left& left) const {
+    return LeftMap::lower_bound(left);
+  }
+
+  template <typename K>
+    requires transparent<CompareLeft>
+  left_iterator lower_bound_left(const K& left) const {
+    return LeftMap::lower_bound(left);
+  }
+
+  left_iterator upper_bound_left(const Left& left) const {
+    return LeftMap::upper_bound(left);
+  }
+
+  template <typename K>
+    requires transparent<CompareLeft>
+  left_iterator upper_bound_left(const K& left) const {
+    return LeftMap::upper_bound(left);
+  }
+
+  right_iterator lower_bound_right(const Right& right) const {
+    return RightMap::lower_bound(right);
+  }
+
+  template <typename K>
+    requires transparent<CompareRight>
+  right_iterator lower_bound_right(const K& right) const {
+    return RightMap::lower_bound(right);
+  }
+
+  right_iterator upper_bound_right(const Right& right) const {
+    return RightMap::upper_bound(right);
+  }
+
+  template <typename K>
+    requires transparent<CompareRight>
+  right_iterator upper_bound_right(const K& right) const {
+    return RightMap::upper_bound(right);
+  }
+
+  // only storages with order statistics provide these, the others reject them at compile time
+  left_iterator nth_left(std::size_t k) const noexcept
+    requires Storage::order_statistics
+  {
+    return LeftMap::nth(k);
+  }
+
+  right_iterator nth_right(std::size_t k) const noexcept
+    requires Storage::order_statistics
+  {
+    return RightMap::nth(k);
+  }
+
+  std::size_t rank_left(const Left& left) const
+    requires Storage::order_statistics
+  {
+    return LeftMap::rank(left);
+  }
+
+  template <typename K>
+    requires Storage::order_statistics && transparent<CompareLeft>
+  std::size_t rank_left(const K& left) const {
+    return LeftMap::rank(left);
+  }
+
+  std::size_t rank_right(const Right& right) const
+    requires Storage::order_statistics
+  {
+    return RightMap::rank(right);
+  }
+
+  template <typename K>
+    requires Storage::order_statistics && transparent<CompareRight>
+  std::size_t rank_right(const K& right) const {
+    return RightMap::rank(right);
+  }
+
+  left_iterator begin_left() const noexcept {
+    return LeftMap::begin();
+  }
+
+  left_iterator end_left() const noexcept {
+    return LeftMap::end();
+  }
+
+  right_iterator begin_right() const noexcept {
+    return RightMap::begin();
+  }
+
+  right_iterator end_right() const noexcept {
+    return RightMap::end();
+  }
+
+  bool empty() const noexcept {
+    return size() == 0;
+  }
+
+  std::size_t size() const noexcept {
+    return sz_;
+  }
+
+  friend bool operator==(const Derived& l, const Derived& r) {
+    if (l.size() != r.size()) {
+      return false;
+    }
+    const CompareLeft& comp_left = static_cast<const LeftMap&>(static_cast<const bimap_base&>(l)).comp_;
+    const CompareRight& comp_right = static_cast<const RightMap&>(static_cast<const bimap_base&>(l)).comp_;
+    left_iterator itl = l.begin_left();
+    left_iterator itr = r.begin_left();
+    for (std::size_t i = 0; i < l.size(); ++i) {
+      if (comp_left(*itl, *itr) || comp_left(*itr, *itl) || comp_right(*itl.flip(), *itr.flip()) ||
+          comp_right(*itr.flip(), *itl.flip())) {
+        return false;
+      }
+      ++itl;
+      ++itr;
+    }
+    return true;
+  }
+
+  friend bool operator!=(const Derived& l, const Derived& r) {
+    return !(l == r);
+  }
+
+protected:
+  std::size_t sz_;
+};
+
+} // namespace bimap_components
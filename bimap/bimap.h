@@ -1,25 +1,59 @@
 #pragma once
 
+#include "bimap-base.h"
+#include "btree.h"
+#include "bulk-load.h"
+#include "clone-map.h"
 #include "map.h"
+#include "pool-allocator.h"
+
+#include <iterator>
+#include <tuple>
+#include <vector>
 
 template <
     typename Left,
     typename Right,
     typename CompareLeft = std::less<Left>,
-    typename CompareRight = std::less<Right>>
+    typename CompareRight = std::less<Right>,
+    typename Storage = bimap_components::rb_tree_storage,
+    typename Allocator = std::allocator<std::pair<Left, Right>>>
 class bimap
-    : bimap_components::map<Left, Right, CompareLeft, bimap_components::tag_left>
-    , bimap_components::map<Left, Right, CompareRight, bimap_components::tag_right> {
+    : public bimap_components::bimap_base<
+          bimap<Left, Right, CompareLeft, CompareRight, Storage, Allocator>,
+          Left,
+          Right,
+          CompareLeft,
+          CompareRight,
+          Storage,
+          bimap_components::map<Left, Right, CompareLeft, bimap_components::tag_left>,
+          bimap_components::map<Left, Right, CompareRight, bimap_components::tag_right>> {
+  static_assert(std::is_same_v<Storage, bimap_components::rb_tree_storage>, "unknown bimap storage");
+
   using LeftMap = bimap_components::map<Left, Right, CompareLeft, bimap_components::tag_left>;
   using RightMap = bimap_components::map<Left, Right, CompareRight, bimap_components::tag_right>;
+  using Base = bimap_components::bimap_base<bimap, Left, Right, CompareLeft, CompareRight, Storage, LeftMap, RightMap>;
   using ValueNode = bimap_components::value_node<Left, Right>;
+  using NodeAllocator = std::allocator_traits<Allocator>::template rebind_alloc<ValueNode>;
+  using NodeTraits = std::allocator_traits<NodeAllocator>;
+
+  friend Base;
 
 public:
-  using left_iterator = LeftMap::iterator;
+  using left_iterator = Base::left_iterator;
 
-  using right_iterator = RightMap::iterator;
+  using right_iterator = Base::right_iterator;
+
+  using Base::begin_left;
+  using Base::end_left;
+  using Base::end_right;
+  using Base::erase_left;
+  using Base::insert;
+  using Base::size;
 
 private:
+  using Base::sz_;
+
   template <typename Tag>
   using tag_type_v = std::conditional_t<std::is_same_v<Tag, bimap_components::tag_left>, Left, Right>;
 
@@ -36,6 +70,86 @@ private:
   template <typename Tag>
   using base_map_v = std::conditional_t<std::is_same_v<Tag, bimap_components::tag_left>, LeftMap, RightMap>;
 
+  template <typename Tag>
+  static const tag_type_v<Tag>& key_of(const ValueNode* nd) noexcept {
+    return static_cast<const bimap_components::value_wrapper<tag_type_v<Tag>, Tag>*>(nd)->val_;
+  }
+
+  template <typename L, typename R>
+  ValueNode* create_node(L&& left, R&& right) {
+    ValueNode* nd = NodeTraits::allocate(alloc_, 1);
+    try {
+      NodeTraits::construct(alloc_, nd, std::forward<L>(left), std::forward<R>(right));
+    } catch (...) {
+      NodeTraits::deallocate(alloc_, nd, 1);
+      throw;
+    }
+    return nd;
+  }
+
+  void destroy_node(ValueNode* nd) noexcept {
+    NodeTraits::destroy(alloc_, nd);
+    NodeTraits::deallocate(alloc_, nd, 1);
+  }
+
+  template <typename It>
+  std::vector<ValueNode*> create_nodes(It first, It last) {
+    std::vector<ValueNode*> nodes;
+    try {
+      for (; first != last; ++first) {
+        nodes.push_back(nullptr);
+        auto&& pair = *first;
+        nodes.back() = create_node(
+            std::get<0>(std::forward<decltype(pair)>(pair)),
+            std::get<1>(std::forward<decltype(pair)>(pair))
+        );
+      }
+    } catch (...) {
+      for (ValueNode* nd : nodes) {
+        if (nd != nullptr) {
+          destroy_node(nd);
+        }
+      }
+      throw;
+    }
+    return nodes;
+  }
+
+  bimap_components::bulk_order<ValueNode> make_bulk_order(std::vector<ValueNode*>& nodes) {
+    try {
+      return bimap_components::make_bulk_order(
+          nodes,
+          [](ValueNode* nd) -> const Left& {
+            return static_cast<bimap_components::value_wrapper<Left, bimap_components::tag_left>*>(nd)->val_;
+          },
+          [](ValueNode* nd) -> const Right& {
+            return static_cast<bimap_components::value_wrapper<Right, bimap_components::tag_right>*>(nd)->val_;
+          },
+          static_cast<const LeftMap&>(*this).comp_,
+          static_cast<const RightMap&>(*this).comp_
+      );
+    } catch (...) {
+      for (ValueNode* nd : nodes) {
+        destroy_node(nd);
+      }
+      throw;
+    }
+  }
+
+  // copies the values of every node once, the copies are found by the address of the original
+  bimap_components::clone_map<ValueNode, ValueNode> clone_nodes(const bimap& other) {
+    bimap_components::clone_map<ValueNode, ValueNode> clones(other.size());
+    try {
+      for (left_iterator it = other.begin_left(); it != other.end_left(); ++it) {
+        clones.insert(static_cast<ValueNode*>(it.nd_), create_node(*it, *it.flip()));
+      }
+    } catch (...) {
+      clones.for_each_copy([this](ValueNode* nd) { destroy_node(nd); });
+      throw;
+    }
+    return clones;
+  }
+
   template <typename Tag>
   bool equal_value(const tag_type_v<Tag>& l, const tag_type_v<Tag>& r) const {
     return !base_map_v<Tag>::comp_(l, r) && !base_map_v<Tag>::comp_(r, l);
@@ -46,20 +160,10 @@ private:
     sz_--;
     base_iterator<Tag> res = base_map_v<Tag>::erase(it.nd_);
     base_map_v<tag_other_v<Tag>>::erase(it.flip().nd_);
-    delete static_cast<ValueNode*>(it.nd_);
+    destroy_node(static_cast<ValueNode*>(it.nd_));
     return res;
   }
 
-  template <typename Tag>
-  bool erase_value(const tag_type_v<Tag>& key) {
-    base_iterator<Tag> it = base_map_v<Tag>::find(key);
-    if (it == base_map_v<Tag>::end()) {
-      return false;
-    }
-    erase_iterator<Tag>(it);
-    return true;
-  }
-
   template <typename Tag>
   const tag_type_v<tag_other_v<Tag>>& at_other_or_default(const tag_type_v<Tag>& key) {
     base_iterator<Tag> it = base_map_v<Tag>::lower_bound(key);
@@ -78,28 +182,68 @@ private:
       bimap_components::base_node<Tag>* cur_node = it2.flip().nd_;
       ValueNode* new_node;
       if constexpr (std::is_same_v<Tag, bimap_components::tag_left>) {
-        new_node = new ValueNode(key, tag_type_v<tag_other_v<Tag>>());
+        new_node = create_node(key, tag_type_v<tag_other_v<Tag>>());
       } else {
-        new_node = new ValueNode(tag_type_v<tag_other_v<Tag>>(), key);
+        new_node = create_node(tag_type_v<tag_other_v<Tag>>(), key);
       }
       base_map_v<Tag>::insert_before(new_node, it.nd_);
       base_map_v<Tag>::erase(cur_node);
       base_map_v<tag_other_v<Tag>>::move_node(it2.nd_, new_node);
-      delete static_cast<ValueNode*>(cur_node);
+      destroy_node(static_cast<ValueNode*>(cur_node));
       return *base_iterator<tag_other_v<Tag>>(new_node);
     }
   }
 
+  // lower bounds of the keys of nodes taken in the given ascending order,
+  // nodes with an already contained key are blocked
+  template <typename Tag>
+  std::vector<bimap_components::base_node<Tag>*> sorted_bounds(
+      const std::vector<ValueNode*>& nodes,
+      const std::vector<std::size_t>& order,
+      std::vector<bool>& blocked
+  ) const {
+    std::vector<bimap_components::base_node<Tag>*> bounds(order.size());
+    base_iterator<Tag> hint = base_map_v<Tag>::begin();
+    for (std::size_t i = 0; i < order.size(); ++i) {
+      const tag_type_v<Tag>& key = key_of<Tag>(nodes[order[i]]);
+      hint = base_map_v<Tag>::lower_bound_hint(hint, key);
+      if (hint != base_map_v<Tag>::end() && equal_value<Tag>(*hint, key)) {
+        blocked[order[i]] = true;
+      }
+      bounds[i] = hint.nd_;
+    }
+    return bounds;
+  }
+
   template <typename L, typename R>
   left_iterator base_insert(L&& left, R&& right) {
-    left_iterator itl = lower_bound_left(left);
-    right_iterator itr = lower_bound_right(right);
+    return insert_at(
+        LeftMap::lower_bound(left),
+        RightMap::lower_bound(right),
+        std::forward<L>(left),
+        std::forward<R>(right)
+    );
+  }
 
+  // a correct hint (or the one before it) makes the insertion amortized O(1) per side
+  template <typename L, typename R>
+  left_iterator base_insert(left_iterator hint_left, right_iterator hint_right, L&& left, R&& right) {
+    return insert_at(
+        LeftMap::lower_bound_hint(hint_left, left),
+        RightMap::lower_bound_hint(hint_right, right),
+        std::forward<L>(left),
+        std::forward<R>(right)
+    );
+  }
+
+  // itl and itr are the lower bounds of left and right
+  template <typename L, typename R>
+  left_iterator insert_at(left_iterator itl, right_iterator itr, L&& left, R&& right) {
     if ((itl != end_left() && equal_value<bimap_components::tag_left>(*itl, left)) ||
         (itr != end_right() && equal_value<bimap_components::tag_right>(*itr, right))) {
       return end_left();
     }
-    auto* nd = new ValueNode(std::forward<L>(left), std::forward<R>(right));
+    auto* nd = create_node(std::forward<L>(left), std::forward<R>(right));
     LeftMap::insert_before(nd, itl.nd_);
     RightMap::insert_before(nd, itr.nd_);
     sz_++;
@@ -107,21 +251,45 @@ private:
   }
 
 public:
-  bimap(CompareLeft compare_left = CompareLeft(), CompareRight compare_right = CompareRight())
-      : LeftMap(&sentinel_, std::move(compare_left))
-      , RightMap(&sentinel_, std::move(compare_right))
+  bimap(
+      CompareLeft compare_left = CompareLeft(),
+      CompareRight compare_right = CompareRight(),
+      const Allocator& alloc = Allocator()
+  )
+      : Base(&sentinel_, std::move(compare_left), std::move(compare_right))
       , sentinel_(true)
-      , sz_(0) {}
+      , alloc_(alloc) {}
+
+  template <std::input_iterator It>
+  bimap(
+      It first,
+      It last,
+      CompareLeft compare_left = CompareLeft(),
+      CompareRight compare_right = CompareRight(),
+      const Allocator& alloc = Allocator()
+  )
+      : bimap(std::move(compare_left), std::move(compare_right), alloc) {
+    assign(first, last);
+  }
 
   bimap(const bimap& other)
-      : bimap(static_cast<const LeftMap&>(other).comp_, static_cast<const RightMap&>(other).comp_) {
-    for (left_iterator it = other.begin_left(); it != other.end_left(); it++) {
-      insert(*it, *it.flip());
-    }
+      : bimap(
+            static_cast<const LeftMap&>(other).comp_,
+            static_cast<const RightMap&>(other).comp_,
+            NodeTraits::select_on_container_copy_construction(other.alloc_)
+        ) {
+    bimap_components::clone_map<ValueNode, ValueNode> clones = clone_nodes(other);
+    LeftMap::clone_links(other, clones);
+    RightMap::clone_links(other, clones);
+    sz_ = other.size();
   }
 
   bimap(bimap&& other) noexcept
-      : bimap(std::move(static_cast<LeftMap&>(other).comp_), std::move(static_cast<RightMap&>(other).comp_)) {
+      : bimap(
+            std::move(static_cast<LeftMap&>(other).comp_),
+            std::move(static_cast<RightMap&>(other).comp_),
+            other.alloc_
+        ) {
     std::swap(sz_, other.sz_);
     LeftMap::swap_sentinel(&sentinel_, &other.sentinel_);
     RightMap::swap_sentinel(&sentinel_, &other.sentinel_);
@@ -149,152 +317,438 @@ public:
     erase_left(begin_left(), end_left());
   }
 
+  // replaces the content with the pairs that inserting the range one by one would keep;
+  // pairs are sorted once per side (input already sorted by key skips it) and linked bottom-up
+  template <std::input_iterator It>
+  void assign(It first, It last) {
+    std::vector<ValueNode*> nodes = create_nodes(first, last);
+    bimap_components::bulk_order<ValueNode> order = make_bulk_order(nodes);
+    erase_left(begin_left(), end_left());
+    for (ValueNode* nd : order.dropped_) {
+      destroy_node(nd);
+    }
+    LeftMap::build(order.left_.data(), order.left_.size());
+    RightMap::build(order.right_.data(), order.right_.size());
+    sz_ = order.left_.size();
+  }
+
   friend void swap(bimap& l, bimap& r) noexcept {
     using std::swap;
     swap(l.sz_, r.sz_);
     swap(static_cast<LeftMap&>(l).comp_, static_cast<LeftMap&>(r).comp_);
     swap(static_cast<RightMap&>(l).comp_, static_cast<RightMap&>(r).comp_);
+    swap(l.alloc_, r.alloc_);
     LeftMap::swap_sentinel(&l.sentinel_, &r.sentinel_);
     RightMap::swap_sentinel(&l.sentinel_, &r.sentinel_);
   }
 
-  left_iterator insert(const Left& left, const Right& right) {
-    return base_insert(left, right);
+  // inserts the pairs that inserting the range one by one would keep; the batch is sorted once per side
+  // and merged into each tree in ascending order, so keys landing between the same neighbours are linked
+  // without descending from the root. Nothing is inserted if a comparison throws
+  template <std::input_iterator It>
+  void insert_range(It first, It last) {
+    std::vector<ValueNode*> nodes = create_nodes(first, last);
+    std::vector<std::size_t> by_left;
+    std::vector<std::size_t> by_right;
+    std::vector<bimap_components::base_node<bimap_components::tag_left>*> left_bounds;
+    std::vector<bimap_components::base_node<bimap_components::tag_right>*> right_bounds;
+    std::vector<bool> keep;
+    try {
+      const CompareLeft& comp_left = LeftMap::comp_;
+      const CompareRight& comp_right = RightMap::comp_;
+      by_left = bimap_components::stable_order(nodes, key_of<bimap_components::tag_left>, comp_left);
+      by_right = bimap_components::stable_order(nodes, key_of<bimap_components::tag_right>, comp_right);
+      std::vector<bool> blocked(nodes.size());
+      left_bounds = sorted_bounds<bimap_components::tag_left>(nodes, by_left, blocked);
+      right_bounds = sorted_bounds<bimap_components::tag_right>(nodes, by_right, blocked);
+      keep = bimap_components::first_unique(
+          bimap_components::key_groups(nodes, by_left, key_of<bimap_components::tag_left>, comp_left),
+          bimap_components::key_groups(nodes, by_right, key_of<bimap_components::tag_right>, comp_right),
+          blocked
+      );
+    } catch (...) {
+      for (ValueNode* nd : nodes) {
+        destroy_node(nd);
+      }
+      throw;
+    }
+    for (std::size_t i = 0; i < nodes.size(); ++i) {
+      if (keep[by_left[i]]) {
+        LeftMap::insert_before(nodes[by_left[i]], left_bounds[i]);
+      }
+      if (keep[by_right[i]]) {
+        RightMap::insert_before(nodes[by_right[i]], right_bounds[i]);
+      }
+      if (keep[i]) {
+        sz_++;
+      } else {
+        destroy_node(nodes[i]);
+      }
+    }
   }
 
-  left_iterator insert(const Left& left, Right&& right) {
-    return base_insert(left, std::move(right));
-  }
 
-  left_iterator insert(Left&& left, const Right& right) {
-    return base_insert(std::move(left), right);
-  }
+private:
+  bimap_components::bimap_node sentinel_;
+  [[no_unique_address]] NodeAllocator alloc_;
+};
 
-  left_iterator insert(Left&& left, Right&& right) {
-    return base_insert(std::move(left), std::move(right));
-  }
+template <
+    typename Left,
+    typename Right,
+    typename CompareLeft,
+    typename CompareRight,
+    std::size_t Degree,
+    typename Allocator>
+class bimap<Left, Right, CompareLeft, CompareRight, bimap_components::btree_storage<Degree>, Allocator>
+    : public bimap_components::bimap_base<
+          bimap<Left, Right, CompareLeft, CompareRight, bimap_components::btree_storage<Degree>, Allocator>,
+          Left,
+          Right,
+          CompareLeft,
+          CompareRight,
+          bimap_components::btree_storage<Degree>,
+          bimap_components::btree_map<Left, Right, CompareLeft, bimap_components::tag_left, Degree, Allocator>,
+          bimap_components::btree_map<Left, Right, CompareRight, bimap_components::tag_right, Degree, Allocator>> {
+  using LeftMap = bimap_components::btree_map<Left, Right, CompareLeft, bimap_components::tag_left, Degree, Allocator>;
+  using RightMap =
+      bimap_components::btree_map<Left, Right, CompareRight, bimap_components::tag_right, Degree, Allocator>;
+  using Base = bimap_components::bimap_base<
+      bimap,
+      Left,
+      Right,
+      CompareLeft,
+      CompareRight,
+      bimap_components::btree_storage<Degree>,
+      LeftMap,
+      RightMap>;
+  using Entry = bimap_components::btree_entry<Left, Right, Degree>;
+  using NodeAllocator = std::allocator_traits<Allocator>::template rebind_alloc<Entry>;
+  using NodeTraits = std::allocator_traits<NodeAllocator>;
+
+  friend Base;
 
-  left_iterator erase_left(left_iterator it) noexcept {
-    return erase_iterator<bimap_components::tag_left>(it);
-  }
+public:
+  using left_iterator = Base::left_iterator;
 
-  right_iterator erase_right(right_iterator it) noexcept {
-    return erase_iterator<bimap_components::tag_right>(it);
-  }
+  using right_iterator = Base::right_iterator;
 
-  bool erase_left(const Left& left) {
-    return erase_value<bimap_components::tag_left>(left);
-  }
+  using Base::begin_left;
+  using Base::end_left;
+  using Base::end_right;
+  using Base::erase_left;
+  using Base::insert;
+  using Base::size;
 
-  bool erase_right(const Right& right) {
-    return erase_value<bimap_components::tag_right>(right);
-  }
+private:
+  using Base::sz_;
 
-  left_iterator erase_left(left_iterator first, left_iterator last) noexcept {
-    while (first != last) {
-      first = erase_left(first);
-    }
-    return last;
-  }
+  template <typename Tag>
+  using tag_type_v = std::conditional_t<std::is_same_v<Tag, bimap_components::tag_left>, Left, Right>;
 
-  right_iterator erase_right(right_iterator first, right_iterator last) noexcept {
-    while (first != last) {
-      first = erase_right(first);
-    }
-    return last;
-  }
+  template <typename Tag>
+  using tag_other_v = std::conditional_t<
+      std::is_same_v<Tag, bimap_components::tag_left>,
+      bimap_components::tag_right,
+      bimap_components::tag_left>;
 
-  left_iterator find_left(const Left& left) const {
-    return LeftMap::find(left);
-  }
+  template <typename Tag>
+  using base_iterator =
+      std::conditional_t<std::is_same_v<Tag, bimap_components::tag_left>, left_iterator, right_iterator>;
 
-  right_iterator find_right(const Right& right) const {
-    return RightMap::find(right);
-  }
+  template <typename Tag>
+  using base_map_v = std::conditional_t<std::is_same_v<Tag, bimap_components::tag_left>, LeftMap, RightMap>;
 
-  const Right& at_left(const Left& key) const {
-    return LeftMap::at_other(key);
+  template <typename L, typename R>
+  Entry* create_node(L&& left, R&& right) {
+    Entry* nd = NodeTraits::allocate(alloc_, 1);
+    try {
+      NodeTraits::construct(alloc_, nd, std::forward<L>(left), std::forward<R>(right));
+    } catch (...) {
+      NodeTraits::deallocate(alloc_, nd, 1);
+      throw;
+    }
+    return nd;
   }
 
-  const Left& at_right(const Right& key) const {
-    return RightMap::at_other(key);
+  void destroy_node(Entry* nd) noexcept {
+    NodeTraits::destroy(alloc_, nd);
+    NodeTraits::deallocate(alloc_, nd, 1);
   }
 
-  const Right& at_left_or_default(const Left& key)
-    requires std::is_default_constructible_v<Right>
-  {
-    return at_other_or_default<bimap_components::tag_left>(key);
+  template <typename It>
+  std::vector<Entry*> create_nodes(It first, It last) {
+    std::vector<Entry*> nodes;
+    try {
+      for (; first != last; ++first) {
+        nodes.push_back(nullptr);
+        auto&& pair = *first;
+        nodes.back() = create_node(
+            std::get<0>(std::forward<decltype(pair)>(pair)),
+            std::get<1>(std::forward<decltype(pair)>(pair))
+        );
+      }
+    } catch (...) {
+      for (Entry* nd : nodes) {
+        if (nd != nullptr) {
+          destroy_node(nd);
+        }
+      }
+      throw;
+    }
+    return nodes;
+  }
+
+  bimap_components::bulk_order<Entry> make_bulk_order(std::vector<Entry*>& nodes) {
+    try {
+      return bimap_components::make_bulk_order(
+          nodes,
+          [](Entry* nd) -> const Left& {
+            return static_cast<bimap_components::value_wrapper<Left, bimap_components::tag_left>*>(nd)->val_;
+          },
+          [](Entry* nd) -> const Right& {
+            return static_cast<bimap_components::value_wrapper<Right, bimap_components::tag_right>*>(nd)->val_;
+          },
+          static_cast<const LeftMap&>(*this).comp_,
+          static_cast<const RightMap&>(*this).comp_
+      );
+    } catch (...) {
+      for (Entry* nd : nodes) {
+        destroy_node(nd);
+      }
+      throw;
+    }
   }
 
-  const Left& at_right_or_default(const Right& key)
-    requires std::is_default_constructible_v<Left>
-  {
-    return at_other_or_default<bimap_components::tag_right>(key);
+  // copies the values of every node once, the copies are found by the address of the original
+  bimap_components::clone_map<Entry, Entry> clone_nodes(const bimap& other) {
+    bimap_components::clone_map<Entry, Entry> clones(other.size());
+    try {
+      for (left_iterator it = other.begin_left(); it != other.end_left(); ++it) {
+        clones.insert(it.entry_, create_node(*it, *it.flip()));
+      }
+    } catch (...) {
+      clones.for_each_copy([this](Entry* nd) { destroy_node(nd); });
+      throw;
+    }
+    return clones;
   }
 
-  left_iterator lower_bound_left(const Left& left) const {
-    return LeftMap::lower_bound(left);
+  template <typename Tag>
+  base_iterator<Tag> erase_iterator(base_iterator<Tag> it) noexcept {
+    sz_--;
+    base_iterator<Tag> res = std::next(it);
+    LeftMap::erase(it.entry_);
+    RightMap::erase(it.entry_);
+    destroy_node(it.entry_);
+    return res;
   }
 
-  left_iterator upper_bound_left(const Left& left) const {
-    return LeftMap::upper_bound(left);
+  template <typename Tag>
+  const tag_type_v<tag_other_v<Tag>>& at_other_or_default(const tag_type_v<Tag>& key) {
+    base_iterator<Tag> it = base_map_v<Tag>::find(key);
+    if (it != base_map_v<Tag>::end()) {
+      return *it.flip();
+    }
+    auto default_value = tag_type_v<tag_other_v<Tag>>();
+    base_iterator<tag_other_v<Tag>> it2 = base_map_v<tag_other_v<Tag>>::find(default_value);
+    if (it2 == base_map_v<tag_other_v<Tag>>::end()) {
+      if constexpr (std::is_same_v<Tag, bimap_components::tag_left>) {
+        return *insert(key, std::move(default_value)).flip();
+      } else {
+        return *insert(std::move(default_value), key);
+      }
+    }
+    Entry* new_entry;
+    if constexpr (std::is_same_v<Tag, bimap_components::tag_left>) {
+      new_entry = create_node(key, std::move(default_value));
+    } else {
+      new_entry = create_node(std::move(default_value), key);
+    }
+    try {
+      base_map_v<Tag>::insert(new_entry);
+    } catch (...) {
+      destroy_node(new_entry);
+      throw;
+    }
+    base_map_v<Tag>::erase(it2.entry_);
+    base_map_v<tag_other_v<Tag>>::replace(it2.entry_, new_entry);
+    destroy_node(it2.entry_);
+    return *base_iterator<tag_other_v<Tag>>(&header_, new_entry);
   }
 
-  right_iterator lower_bound_right(const Right& right) const {
-    return RightMap::lower_bound(right);
+  template <typename L, typename R>
+  left_iterator base_insert(L&& left, R&& right) {
+    if (LeftMap::find(left) != end_left() || RightMap::find(right) != end_right()) {
+      return end_left();
+    }
+    auto* e = create_node(std::forward<L>(left), std::forward<R>(right));
+    try {
+      LeftMap::insert(e);
+    } catch (...) {
+      destroy_node(e);
+      throw;
+    }
+    try {
+      RightMap::insert(e);
+    } catch (...) {
+      LeftMap::erase(e);
+      destroy_node(e);
+      throw;
+    }
+    sz_++;
+    return left_iterator(&header_, e);
   }
 
-  right_iterator upper_bound_right(const Right& right) const {
-    return RightMap::upper_bound(right);
+  // B-tree nodes are wide and shallow, so the hints are not used
+  template <typename L, typename R>
+  left_iterator base_insert(left_iterator, right_iterator, L&& left, R&& right) {
+    return base_insert(std::forward<L>(left), std::forward<R>(right));
   }
 
-  left_iterator begin_left() const noexcept {
-    return LeftMap::begin();
+  void clear() noexcept {
+    for (left_iterator it = begin_left(); it != end_left();) {
+      Entry* e = it.entry_;
+      ++it;
+      destroy_node(e);
+    }
+    LeftMap::clear();
+    RightMap::clear();
+    sz_ = 0;
   }
 
-  left_iterator end_left() const noexcept {
-    return LeftMap::end();
+public:
+  bimap(
+      CompareLeft compare_left = CompareLeft(),
+      CompareRight compare_right = CompareRight(),
+      const Allocator& alloc = Allocator()
+  )
+      : Base(&header_, std::move(compare_left), std::move(compare_right), alloc)
+      , alloc_(alloc) {}
+
+  template <std::input_iterator It>
+  bimap(
+      It first,
+      It last,
+      CompareLeft compare_left = CompareLeft(),
+      CompareRight compare_right = CompareRight(),
+      const Allocator& alloc = Allocator()
+  )
+      : bimap(std::move(compare_left), std::move(compare_right), alloc) {
+    assign(first, last);
   }
 
-  right_iterator begin_right() const noexcept {
-    return RightMap::begin();
+  bimap(const bimap& other)
+      : bimap(
+            static_cast<const LeftMap&>(other).comp_,
+            static_cast<const RightMap&>(other).comp_,
+            NodeTraits::select_on_container_copy_construction(other.alloc_)
+        ) {
+    bimap_components::clone_map<Entry, Entry> clones = clone_nodes(other);
+    typename LeftMap::node_type* left_root = nullptr;
+    typename RightMap::node_type* right_root = nullptr;
+    try {
+      left_root = LeftMap::clone(static_cast<const LeftMap&>(other).get_root_node(), clones);
+      right_root = RightMap::clone(static_cast<const RightMap&>(other).get_root_node(), clones);
+    } catch (...) {
+      if (left_root != nullptr) {
+        LeftMap::deallocate_subtree(left_root);
+      }
+      clones.for_each_copy([this](Entry* e) { destroy_node(e); });
+      throw;
+    }
+    LeftMap::assign_root(left_root);
+    RightMap::assign_root(right_root);
+    sz_ = other.size();
   }
 
-  right_iterator end_right() const noexcept {
-    return RightMap::end();
+  bimap(bimap&& other) noexcept
+      : bimap(
+            std::move(static_cast<LeftMap&>(other).comp_),
+            std::move(static_cast<RightMap&>(other).comp_),
+            other.alloc_
+        ) {
+    std::swap(sz_, other.sz_);
+    std::swap(header_.left_root_, other.header_.left_root_);
+    std::swap(header_.right_root_, other.header_.right_root_);
   }
 
-  bool empty() const noexcept {
-    return size() == 0;
+  bimap& operator=(const bimap& other) {
+    if (this == &other) {
+      return *this;
+    }
+    bimap temp = other;
+    swap(*this, temp);
+    return *this;
   }
 
-  std::size_t size() const noexcept {
-    return sz_;
+  bimap& operator=(bimap&& other) noexcept {
+    if (this == &other) {
+      return *this;
+    }
+    bimap temp = std::move(other);
+    swap(*this, temp);
+    return *this;
   }
 
-  friend bool operator==(const bimap& l, const bimap& r) {
-    if (l.size() != r.size()) {
-      return false;
-    }
-    left_iterator itl = l.begin_left();
-    left_iterator itr = r.begin_left();
-    for (size_t i = 0; i < l.size(); ++i) {
-      if (static_cast<const LeftMap&>(l).comp_(*itl, *itr) || static_cast<const LeftMap&>(l).comp_(*itr, *itl) ||
-          static_cast<const RightMap&>(l).comp_(*itl.flip(), *itr.flip()) ||
-          static_cast<const RightMap&>(l).comp_(*itr.flip(), *itl.flip())) {
-        return false;
+  ~bimap() {
+    clear();
+  }
+
+  // replaces the content with the pairs that inserting the range one by one would keep;
+  // pairs are sorted once per side (input already sorted by key skips it) and packed bottom-up
+  template <std::input_iterator It>
+  void assign(It first, It last) {
+    std::vector<Entry*> entries = create_nodes(first, last);
+    bimap_components::bulk_order<Entry> order = make_bulk_order(entries);
+    typename LeftMap::node_type* left_root = nullptr;
+    typename RightMap::node_type* right_root = nullptr;
+    try {
+      left_root = LeftMap::build(order.left_.data(), order.left_.size());
+      right_root = RightMap::build(order.right_.data(), order.right_.size());
+    } catch (...) {
+      if (left_root != nullptr) {
+        LeftMap::deallocate_subtree(left_root);
+      }
+      for (Entry* e : entries) {
+        destroy_node(e);
       }
-      ++itl;
-      ++itr;
+      throw;
     }
-    return true;
+    clear();
+    for (Entry* e : order.dropped_) {
+      destroy_node(e);
+    }
+    LeftMap::assign_root(left_root);
+    RightMap::assign_root(right_root);
+    sz_ = order.left_.size();
   }
 
-  friend bool operator!=(const bimap& l, const bimap& r) {
-    return !(l == r);
+  friend void swap(bimap& l, bimap& r) noexcept {
+    using std::swap;
+    swap(l.sz_, r.sz_);
+    swap(static_cast<LeftMap&>(l).comp_, static_cast<LeftMap&>(r).comp_);
+    swap(static_cast<RightMap&>(l).comp_, static_cast<RightMap&>(r).comp_);
+    swap(l.alloc_, r.alloc_);
+    swap(static_cast<LeftMap&>(l).leaf_alloc_, static_cast<LeftMap&>(r).leaf_alloc_);
+    swap(static_cast<LeftMap&>(l).inner_alloc_, static_cast<LeftMap&>(r).inner_alloc_);
+    swap(static_cast<RightMap&>(l).leaf_alloc_, static_cast<RightMap&>(r).leaf_alloc_);
+    swap(static_cast<RightMap&>(l).inner_alloc_, static_cast<RightMap&>(r).inner_alloc_);
+    swap(l.header_.left_root_, r.header_.left_root_);
+    swap(l.header_.right_root_, r.header_.right_root_);
+  }
+
+  // inserts the pairs that inserting the range one by one would keep
+  template <std::input_iterator It>
+  void insert_range(It first, It last) {
+    for (; first != last; ++first) {
+      auto&& pair = *first;
+      base_insert(std::get<0>(std::forward<decltype(pair)>(pair)), std::get<1>(std::forward<decltype(pair)>(pair)));
+    }
   }
 
+
 private:
-  bimap_components::bimap_node sentinel_;
-  size_t sz_;
+  bimap_components::btree_header<Left, Right, Degree> header_;
+  [[no_unique_address]] NodeAllocator alloc_;
 };
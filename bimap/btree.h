@@ -0,0 +1,739 @@
+#pragma once
+
+#include "nodes.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+
+template <typename T, typename Other, typename CompareLeft, typename CompareRight, typename Storage, typename Allocator>
+class bimap;
+
+namespace bimap_components {
+
+// stores both indexes as B-trees holding up to 2 * Degree - 1 entries per node
+template <std::size_t Degree = 16>
+struct btree_storage {
+  static_assert(Degree >= 2, "B-tree degree must be at least 2");
+
+  static constexpr bool order_statistics = false;
+};
+
+template <typename Entry, typename Tag, std::size_t Degree>
+class btree_inner_node;
+
+template <typename Entry, typename Tag, std::size_t Degree>
+class btree_node;
+
+// position of an entry inside the index of the given side
+template <typename Entry, typename Tag, std::size_t Degree>
+class btree_slot {
+public:
+  btree_node<Entry, Tag, Degree>* node_ = nullptr;
+  std::uint32_t pos_ = 0;
+};
+
+template <typename Left, typename Right, std::size_t Degree>
+class btree_entry
+    : public value_wrapper<Left, tag_left>
+    , public value_wrapper<Right, tag_right>
+    , public btree_slot<btree_entry<Left, Right, Degree>, tag_left, Degree>
+    , public btree_slot<btree_entry<Left, Right, Degree>, tag_right, Degree> {
+public:
+  template <typename L, typename R>
+  btree_entry(L&& left, R&& right)
+      : value_wrapper<Left, tag_left>(std::forward<L>(left))
+      , value_wrapper<Right, tag_right>(std::forward<R>(right)) {}
+};
+
+template <typename Entry, typename Tag>
+struct btree_key;
+
+template <typename Left, typename Right, std::size_t Degree>
+struct btree_key<btree_entry<Left, Right, Degree>, tag_left> {
+  using type = Left;
+};
+
+template <typename Left, typename Right, std::size_t Degree>
+struct btree_key<btree_entry<Left, Right, Degree>, tag_right> {
+  using type = Right;
+};
+
+// keys this small and trivial are also copied into the node, so the binary search inside
+// a node reads only the node instead of a separately allocated entry per probe
+template <typename T>
+inline constexpr bool inline_key_v = std::is_trivial_v<T> && sizeof(T) <= 16;
+
+template <typename T, std::size_t N, bool Inline = inline_key_v<T>>
+struct btree_key_cache {
+  void set(std::uint32_t i, const T& key) noexcept {
+    keys_[i] = key;
+  }
+
+  T keys_[N];
+};
+
+template <typename T, std::size_t N>
+struct btree_key_cache<T, N, false> {
+  void set(std::uint32_t, const T&) noexcept {}
+};
+
+template <typename Entry, typename Tag, std::size_t Degree>
+class btree_node {
+  using slot = btree_slot<Entry, Tag, Degree>;
+  using key_type = btree_key<Entry, Tag>::type;
+
+public:
+  static constexpr std::size_t max_keys = 2 * Degree - 1;
+  static constexpr std::size_t min_keys = Degree - 1;
+
+  btree_node* parent_;
+  std::uint32_t count_;
+  std::uint32_t index_;
+  bool leaf_;
+  [[no_unique_address]] btree_key_cache<key_type, max_keys> cache_;
+  Entry* keys_[max_keys];
+
+public:
+  explicit btree_node(bool leaf) noexcept
+      : parent_(nullptr)
+      , count_(0)
+      , index_(0)
+      , leaf_(leaf) {}
+
+  btree_node** children() noexcept {
+    return static_cast<btree_inner_node<Entry, Tag, Degree>*>(this)->children_;
+  }
+
+  void set_key(std::uint32_t i, Entry* entry) noexcept {
+    keys_[i] = entry;
+    cache_.set(i, static_cast<value_wrapper<key_type, Tag>&>(*entry).val_);
+    static_cast<slot&>(*entry).node_ = this;
+    static_cast<slot&>(*entry).pos_ = i;
+  }
+
+  void set_child(std::uint32_t i, btree_node* child) noexcept {
+    children()[i] = child;
+    child->parent_ = this;
+    child->index_ = i;
+  }
+
+  static Entry* first(btree_node* nd) noexcept {
+    if (nd == nullptr) {
+      return nullptr;
+    }
+    while (!nd->leaf_) {
+      nd = nd->children()[0];
+    }
+    return nd->keys_[0];
+  }
+
+  static Entry* last(btree_node* nd) noexcept {
+    if (nd == nullptr) {
+      return nullptr;
+    }
+    while (!nd->leaf_) {
+      nd = nd->children()[nd->count_];
+    }
+    return nd->keys_[nd->count_ - 1];
+  }
+
+  // returns nullptr after the greatest entry
+  static Entry* get_next(Entry* entry) noexcept {
+    btree_node* nd = static_cast<slot&>(*entry).node_;
+    std::uint32_t pos = static_cast<slot&>(*entry).pos_;
+    if (!nd->leaf_) {
+      nd = nd->children()[pos + 1];
+      while (!nd->leaf_) {
+        nd = nd->children()[0];
+      }
+      return nd->keys_[0];
+    }
+    if (pos + 1 < nd->count_) {
+      return nd->keys_[pos + 1];
+    }
+    while (nd->parent_ != nullptr && nd->index_ == nd->parent_->count_) {
+      nd = nd->parent_;
+    }
+    return nd->parent_ == nullptr ? nullptr : nd->parent_->keys_[nd->index_];
+  }
+
+  static Entry* get_prev(Entry* entry) noexcept {
+    btree_node* nd = static_cast<slot&>(*entry).node_;
+    std::uint32_t pos = static_cast<slot&>(*entry).pos_;
+    if (!nd->leaf_) {
+      nd = nd->children()[pos];
+      while (!nd->leaf_) {
+        nd = nd->children()[nd->count_];
+      }
+      return nd->keys_[nd->count_ - 1];
+    }
+    if (pos > 0) {
+      return nd->keys_[pos - 1];
+    }
+    while (nd->parent_ != nullptr && nd->index_ == 0) {
+      nd = nd->parent_;
+    }
+    return nd->parent_ == nullptr ? nullptr : nd->parent_->keys_[nd->index_ - 1];
+  }
+};
+
+template <typename Entry, typename Tag, std::size_t Degree>
+class btree_inner_node : public btree_node<Entry, Tag, Degree> {
+public:
+  btree_node<Entry, Tag, Degree>* children_[btree_node<Entry, Tag, Degree>::max_keys + 1];
+
+public:
+  btree_inner_node() noexcept
+      : btree_node<Entry, Tag, Degree>(false) {}
+};
+
+template <typename Left, typename Right, std::size_t Degree>
+class btree_header {
+  using entry = btree_entry<Left, Right, Degree>;
+
+public:
+  template <typename Tag>
+  using node = btree_node<entry, Tag, Degree>;
+
+  template <typename Tag>
+  node<Tag>*& root() noexcept {
+    if constexpr (std::is_same_v<Tag, tag_left>) {
+      return left_root_;
+    } else {
+      return right_root_;
+    }
+  }
+
+  template <typename Tag>
+  node<Tag>* root() const noexcept {
+    if constexpr (std::is_same_v<Tag, tag_left>) {
+      return left_root_;
+    } else {
+      return right_root_;
+    }
+  }
+
+public:
+  node<tag_left>* left_root_ = nullptr;
+  node<tag_right>* right_root_ = nullptr;
+};
+
+template <typename T, typename Other, typename Compare, typename Tag, std::size_t Degree, typename Allocator>
+class btree_map;
+
+template <typename T, typename Other, typename Tag, std::size_t Degree>
+class btree_iterator {
+  using Left = std::conditional_t<std::is_same_v<Tag, tag_left>, T, Other>;
+  using Right = std::conditional_t<std::is_same_v<Tag, tag_left>, Other, T>;
+  using OtherTag = std::conditional_t<std::is_same_v<Tag, tag_left>, tag_right, tag_left>;
+  using OtherIterator = btree_iterator<Other, T, OtherTag, Degree>;
+  using entry = btree_entry<Left, Right, Degree>;
+  using header = btree_header<Left, Right, Degree>;
+  using node = btree_node<entry, Tag, Degree>;
+
+public:
+  using difference_type = std::ptrdiff_t;
+  using value_type = T;
+  using pointer = const T*;
+  using reference = const T&;
+  using iterator_category = std::bidirectional_iterator_tag;
+
+private:
+  template <typename L, typename R, typename C, typename Tg, std::size_t D, typename A>
+  friend class btree_map;
+
+  template <typename Y, typename OtherY, typename CL, typename CR, typename S, typename A>
+  friend class ::bimap;
+
+  template <typename Y, typename OtherY, typename Tg, std::size_t D>
+  friend class btree_iterator;
+
+  btree_iterator(const header* hdr, entry* cur_entry) noexcept
+      : header_(hdr)
+      , entry_(cur_entry) {}
+
+public:
+  btree_iterator() noexcept
+      : header_(nullptr)
+      , entry_(nullptr) {}
+
+  reference operator*() const noexcept {
+    return static_cast<value_wrapper<T, Tag>*>(entry_)->val_;
+  }
+
+  operator OtherIterator() const noexcept {
+    return {header_, entry_};
+  }
+
+  pointer operator->() const noexcept {
+    return &**this;
+  }
+
+  btree_iterator& operator++() noexcept {
+    entry_ = node::get_next(entry_);
+    return *this;
+  }
+
+  btree_iterator operator++(int) noexcept {
+    btree_iterator tmp = *this;
+    ++*this;
+    return tmp;
+  }
+
+  btree_iterator& operator--() noexcept {
+    if (entry_ == nullptr) {
+      entry_ = node::last(header_->template root<Tag>());
+    } else {
+      entry_ = node::get_prev(entry_);
+    }
+    return *this;
+  }
+
+  btree_iterator operator--(int) noexcept {
+    btree_iterator tmp = *this;
+    --*this;
+    return tmp;
+  }
+
+  OtherIterator flip() const noexcept {
+    return {header_, entry_};
+  }
+
+  friend bool operator==(const btree_iterator& lhs, const btree_iterator& rhs) noexcept {
+    return lhs.entry_ == rhs.entry_;
+  }
+
+  friend bool operator!=(const btree_iterator& lhs, const btree_iterator& rhs) noexcept {
+    return !(lhs == rhs);
+  }
+
+private:
+  const header* header_;
+  entry* entry_;
+};
+
+// tree nodes of both kinds come from Allocator rebound to them, like the entries do
+template <typename Left, typename Right, typename Compare, typename Tag, std::size_t Degree, typename Allocator>
+class btree_map {
+  using T = std::conditional_t<std::is_same_v<Tag, tag_left>, Left, Right>;
+  using Other = std::conditional_t<std::is_same_v<Tag, tag_left>, Right, Left>;
+  using entry = btree_entry<Left, Right, Degree>;
+  using node = btree_node<entry, Tag, Degree>;
+  using inner_node = btree_inner_node<entry, Tag, Degree>;
+  using header = btree_header<Left, Right, Degree>;
+  using leaf_allocator = std::allocator_traits<Allocator>::template rebind_alloc<node>;
+  using leaf_traits = std::allocator_traits<leaf_allocator>;
+  using inner_allocator = std::allocator_traits<Allocator>::template rebind_alloc<inner_node>;
+  using inner_traits = std::allocator_traits<inner_allocator>;
+
+public:
+  using iterator = btree_iterator<T, Other, Tag, Degree>;
+  using node_type = node;
+
+public:
+  btree_map(header* hdr, Compare comp, const Allocator& alloc)
+      : header_(hdr)
+      , comp_(std::move(comp))
+      , leaf_alloc_(alloc)
+      , inner_alloc_(alloc) {}
+
+private:
+  static const T& as_val(entry* e) noexcept {
+    return static_cast<value_wrapper<T, Tag>*>(e)->val_;
+  }
+
+  static const T& key_at(const node* nd, std::uint32_t i) noexcept {
+    if constexpr (inline_key_v<T>) {
+      return nd->cache_.keys_[i];
+    } else {
+      return as_val(nd->keys_[i]);
+    }
+  }
+
+  node*& get_root() const noexcept {
+    return header_->template root<Tag>();
+  }
+
+  node* allocate_node(bool leaf) {
+    if (leaf) {
+      node* nd = leaf_traits::allocate(leaf_alloc_, 1);
+      leaf_traits::construct(leaf_alloc_, nd, true);
+      return nd;
+    }
+    inner_node* nd = inner_traits::allocate(inner_alloc_, 1);
+    inner_traits::construct(inner_alloc_, nd);
+    return nd;
+  }
+
+  void deallocate_node(node* nd) noexcept {
+    if (nd->leaf_) {
+      leaf_traits::destroy(leaf_alloc_, nd);
+      leaf_traits::deallocate(leaf_alloc_, nd, 1);
+    } else {
+      inner_node* inner = static_cast<inner_node*>(nd);
+      inner_traits::destroy(inner_alloc_, inner);
+      inner_traits::deallocate(inner_alloc_, inner, 1);
+    }
+  }
+
+  // index of the first key in nd that is not less than key
+  template <typename K>
+  std::uint32_t lower_index(node* nd, const K& key) const {
+    std::uint32_t lo = 0;
+    std::uint32_t hi = nd->count_;
+    while (lo < hi) {
+      std::uint32_t mid = lo + (hi - lo) / 2;
+      if (comp_(key_at(nd, mid), key)) {
+        lo = mid + 1;
+      } else {
+        hi = mid;
+      }
+    }
+    return lo;
+  }
+
+  // moves the upper half of the full i-th child of nd into sibling and lifts the median into nd
+  static void split_child(node* nd, std::uint32_t i, node* sibling) noexcept {
+    node* child = nd->children()[i];
+    for (std::uint32_t j = 0; j < Degree - 1; ++j) {
+      sibling->set_key(j, child->keys_[j + Degree]);
+    }
+    if (!child->leaf_) {
+      for (std::uint32_t j = 0; j < Degree; ++j) {
+        sibling->set_child(j, child->children()[j + Degree]);
+      }
+    }
+    sibling->count_ = Degree - 1;
+    child->count_ = Degree - 1;
+    for (std::uint32_t j = nd->count_; j > i; --j) {
+      nd->set_key(j, nd->keys_[j - 1]);
+      nd->set_child(j + 1, nd->children()[j]);
+    }
+    nd->set_key(i, child->keys_[Degree - 1]);
+    nd->set_child(i + 1, sibling);
+    nd->count_++;
+  }
+
+  // moves the last key of the i-th child of nd through nd into the (i + 1)-th child
+  static void rotate_right(node* nd, std::uint32_t i) noexcept {
+    node* left = nd->children()[i];
+    node* right = nd->children()[i + 1];
+    for (std::uint32_t j = right->count_; j > 0; --j) {
+      right->set_key(j, right->keys_[j - 1]);
+    }
+    if (!right->leaf_) {
+      for (std::uint32_t j = right->count_ + 1; j > 0; --j) {
+        right->set_child(j, right->children()[j - 1]);
+      }
+      right->set_child(0, left->children()[left->count_]);
+    }
+    right->set_key(0, nd->keys_[i]);
+    nd->set_key(i, left->keys_[left->count_ - 1]);
+    left->count_--;
+    right->count_++;
+  }
+
+  // moves the first key of the (i + 1)-th child of nd through nd into the i-th child
+  static void rotate_left(node* nd, std::uint32_t i) noexcept {
+    node* left = nd->children()[i];
+    node* right = nd->children()[i + 1];
+    left->set_key(left->count_, nd->keys_[i]);
+    if (!left->leaf_) {
+      left->set_child(left->count_ + 1, right->children()[0]);
+      for (std::uint32_t j = 0; j < right->count_; ++j) {
+        right->set_child(j, right->children()[j + 1]);
+      }
+    }
+    left->count_++;
+    nd->set_key(i, right->keys_[0]);
+    for (std::uint32_t j = 0; j + 1 < right->count_; ++j) {
+      right->set_key(j, right->keys_[j + 1]);
+    }
+    right->count_--;
+  }
+
+  // glues the (i + 1)-th child of nd and the i-th key of nd onto the i-th child
+  void merge_children(node* nd, std::uint32_t i) noexcept {
+    node* left = nd->children()[i];
+    node* right = nd->children()[i + 1];
+    left->set_key(left->count_, nd->keys_[i]);
+    for (std::uint32_t j = 0; j < right->count_; ++j) {
+      left->set_key(left->count_ + 1 + j, right->keys_[j]);
+    }
+    if (!left->leaf_) {
+      for (std::uint32_t j = 0; j <= right->count_; ++j) {
+        left->set_child(left->count_ + 1 + j, right->children()[j]);
+      }
+    }
+    left->count_ += right->count_ + 1;
+    for (std::uint32_t j = i; j + 1 < nd->count_; ++j) {
+      nd->set_key(j, nd->keys_[j + 1]);
+      nd->set_child(j + 1, nd->children()[j + 2]);
+    }
+    nd->count_--;
+    deallocate_node(right);
+  }
+
+  void rebalance(node* nd) noexcept {
+    while (nd->parent_ != nullptr && nd->count_ < node::min_keys) {
+      node* parent = nd->parent_;
+      std::uint32_t i = nd->index_;
+      if (i > 0 && parent->children()[i - 1]->count_ > node::min_keys) {
+        rotate_right(parent, i - 1);
+        return;
+      }
+      if (i < parent->count_ && parent->children()[i + 1]->count_ > node::min_keys) {
+        rotate_left(parent, i);
+        return;
+      }
+      merge_children(parent, i > 0 ? i - 1 : i);
+      nd = parent;
+    }
+    node*& root = get_root();
+    if (root->count_ == 0) {
+      node* old_root = root;
+      if (root->leaf_) {
+        root = nullptr;
+      } else {
+        root = root->children()[0];
+        root->parent_ = nullptr;
+        root->index_ = 0;
+      }
+      deallocate_node(old_root);
+    }
+  }
+
+  node* build_subtree(entry* const* entries, std::size_t count, std::size_t height, std::size_t capacity) {
+    if (height == 0) {
+      node* leaf = allocate_node(true);
+      for (std::uint32_t i = 0; i < count; ++i) {
+        leaf->set_key(i, entries[i]);
+      }
+      leaf->count_ = static_cast<std::uint32_t>(count);
+      return leaf;
+    }
+    std::size_t child_capacity = (capacity - node::max_keys) / (node::max_keys + 1);
+    std::size_t children = std::max<std::size_t>(2, (count + child_capacity + 1) / (child_capacity + 1));
+    std::size_t keys = count - (children - 1);
+    node* nd = allocate_node(false);
+    try {
+      for (std::uint32_t i = 0; i < children; ++i) {
+        std::size_t child_count = keys / children + (i < keys % children ? 1 : 0);
+        nd->set_child(i, build_subtree(entries, child_count, height - 1, child_capacity));
+        entries += child_count;
+        if (i + 1 < children) {
+          nd->set_key(i, *entries++);
+          nd->count_++;
+        }
+      }
+    } catch (...) {
+      for (std::uint32_t i = 0; i < nd->count_; ++i) {
+        deallocate_subtree(nd->children()[i]);
+      }
+      deallocate_node(nd);
+      throw;
+    }
+    return nd;
+  }
+
+public:
+  // builds a detached tree over entries sorted by key without equivalent ones;
+  // subtrees are filled evenly, so every node stays between min_keys and max_keys
+  node* build(entry* const* entries, std::size_t count) {
+    if (count == 0) {
+      return nullptr;
+    }
+    std::size_t height = 0;
+    std::size_t capacity = node::max_keys;
+    while (capacity < count) {
+      height++;
+      capacity = node::max_keys + (node::max_keys + 1) * capacity;
+    }
+    return build_subtree(entries, count, height, capacity);
+  }
+
+  void deallocate_subtree(node* nd) noexcept {
+    if (!nd->leaf_) {
+      for (std::uint32_t i = 0; i <= nd->count_; ++i) {
+        deallocate_subtree(nd->children()[i]);
+      }
+    }
+    deallocate_node(nd);
+  }
+
+  // copies the structure of the subtree, putting the copy of each entry where the original was
+  template <typename Clones>
+  node* clone(node* nd, const Clones& clones) {
+    if (nd == nullptr) {
+      return nullptr;
+    }
+    node* res = allocate_node(nd->leaf_);
+    for (std::uint32_t i = 0; i < nd->count_; ++i) {
+      res->set_key(i, clones.at(nd->keys_[i]));
+    }
+    res->count_ = nd->count_;
+    if (!nd->leaf_) {
+      std::uint32_t i = 0;
+      try {
+        for (; i <= nd->count_; ++i) {
+          res->set_child(i, clone(nd->children()[i], clones));
+        }
+      } catch (...) {
+        for (std::uint32_t j = 0; j < i; ++j) {
+          deallocate_subtree(res->children()[j]);
+        }
+        deallocate_node(res);
+        throw;
+      }
+    }
+    return res;
+  }
+
+  node* get_root_node() const noexcept {
+    return get_root();
+  }
+
+  void assign_root(node* root) noexcept {
+    get_root() = root;
+  }
+
+  // entry must not be equivalent to any stored one; the index is left valid if allocation throws
+  void insert(entry* e) {
+    const T& key = as_val(e);
+    node*& root = get_root();
+    if (root == nullptr) {
+      root = allocate_node(true);
+      root->set_key(0, e);
+      root->count_ = 1;
+      return;
+    }
+    if (root->count_ == node::max_keys) {
+      node* new_root = allocate_node(false);
+      node* sibling;
+      try {
+        sibling = allocate_node(root->leaf_);
+      } catch (...) {
+        deallocate_node(new_root);
+        throw;
+      }
+      new_root->set_child(0, root);
+      root = new_root;
+      split_child(new_root, 0, sibling);
+    }
+    node* nd = root;
+    while (!nd->leaf_) {
+      std::uint32_t i = lower_index(nd, key);
+      node* child = nd->children()[i];
+      if (child->count_ == node::max_keys) {
+        split_child(nd, i, allocate_node(child->leaf_));
+        if (comp_(key_at(nd, i), key)) {
+          ++i;
+        }
+      }
+      nd = nd->children()[i];
+    }
+    std::uint32_t i = lower_index(nd, key);
+    for (std::uint32_t j = nd->count_; j > i; --j) {
+      nd->set_key(j, nd->keys_[j - 1]);
+    }
+    nd->set_key(i, e);
+    nd->count_++;
+  }
+
+  void erase(entry* e) noexcept {
+    node* nd = static_cast<btree_slot<entry, Tag, Degree>&>(*e).node_;
+    std::uint32_t pos = static_cast<btree_slot<entry, Tag, Degree>&>(*e).pos_;
+    if (!nd->leaf_) {
+      node* leaf = nd->children()[pos];
+      while (!leaf->leaf_) {
+        leaf = leaf->children()[leaf->count_];
+      }
+      nd->set_key(pos, leaf->keys_[leaf->count_ - 1]);
+      nd = leaf;
+      pos = leaf->count_ - 1;
+    }
+    for (std::uint32_t j = pos; j + 1 < nd->count_; ++j) {
+      nd->set_key(j, nd->keys_[j + 1]);
+    }
+    nd->count_--;
+    rebalance(nd);
+  }
+
+  // puts replacement at the position of an equivalent stored entry
+  static void replace(entry* stored, entry* replacement) noexcept {
+    btree_slot<entry, Tag, Degree>& pos = *stored;
+    pos.node_->set_key(pos.pos_, replacement);
+  }
+
+  void clear() noexcept {
+    if (get_root() != nullptr) {
+      deallocate_subtree(get_root());
+      get_root() = nullptr;
+    }
+  }
+
+  iterator begin() const noexcept {
+    return iterator(header_, node::first(get_root()));
+  }
+
+  iterator end() const noexcept {
+    return iterator(header_, nullptr);
+  }
+
+  template <typename K>
+  iterator lower_bound(const K& key) const {
+    entry* candidate = nullptr;
+    node* nd = get_root();
+    while (nd != nullptr) {
+      std::uint32_t i = lower_index(nd, key);
+      if (i < nd->count_) {
+        if (!comp_(key, key_at(nd, i))) {
+          return iterator(header_, nd->keys_[i]);
+        }
+        candidate = nd->keys_[i];
+      }
+      nd = nd->leaf_ ? nullptr : nd->children()[i];
+    }
+    return iterator(header_, candidate);
+  }
+
+  template <typename K>
+  iterator upper_bound(const K& value) const {
+    iterator it = lower_bound(value);
+    if (it != end() && !comp_(value, *it)) {
+      it++;
+    }
+    return it;
+  }
+
+  template <typename K>
+  iterator find(const K& value) const {
+    iterator it = lower_bound(value);
+    if (it == end() || comp_(value, *it)) {
+      return end();
+    }
+    return it;
+  }
+
+  template <typename K>
+  const Other& at_other(const K& key) const {
+    iterator it = find(key);
+    if (it == end()) {
+      throw std::out_of_range("key is not contained in the container");
+    } else {
+      return *it.flip();
+    }
+  }
+
+public:
+  header* header_;
+  [[no_unique_address]] Compare comp_;
+  [[no_unique_address]] leaf_allocator leaf_alloc_;
+  [[no_unique_address]] inner_allocator inner_alloc_;
+};
+
+} // namespace bimap_components
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <numeric>
+#include <vector>
+
+namespace bimap_components {
+
+// positions of items ordered by key, equivalent keys keep their input order
+template <typename Item, typename Key, typename Compare>
+std::vector<std::size_t> stable_order(const std::vector<Item*>& items, Key key, const Compare& comp) {
+  std::vector<std::size_t> order(items.size());
+  std::iota(order.begin(), order.end(), 0);
+  auto less = [&](std::size_t a, std::size_t b) { return comp(key(items[a]), key(items[b])); };
+  if (!std::is_sorted(order.begin(), order.end(), less)) {
+    std::stable_sort(order.begin(), order.end(), less);
+  }
+  return order;
+}
+
+// groups equivalent keys of a sorted order under the position of the first of them
+template <typename Item, typename Key, typename Compare>
+std::vector<std::size_t> key_groups(
+    const std::vector<Item*>& items,
+    const std::vector<std::size_t>& order,
+    Key key,
+    const Compare& comp
+) {
+  std::vector<std::size_t> groups(items.size());
+  for (std::size_t i = 0; i < order.size(); ++i) {
+    if (i > 0 && !comp(key(items[order[i - 1]]), key(items[order[i]]))) {
+      groups[order[i]] = groups[order[i - 1]];
+    } else {
+      groups[order[i]] = i;
+    }
+  }
+  return groups;
+}
+
+// marks the items that inserting them one by one would keep:
+// an item is dropped when it is blocked or an item with an equivalent left or right key was kept before it
+inline std::vector<bool> first_unique(
+    const std::vector<std::size_t>& left_groups,
+    const std::vector<std::size_t>& right_groups,
+    const std::vector<bool>& blocked
+) {
+  std::size_t n = left_groups.size();
+  std::vector<bool> used_left(n);
+  std::vector<bool> used_right(n);
+  std::vector<bool> keep(n);
+  for (std::size_t i = 0; i < n; ++i) {
+    if (!blocked[i] && !used_left[left_groups[i]] && !used_right[right_groups[i]]) {
+      used_left[left_groups[i]] = true;
+      used_right[right_groups[i]] = true;
+      keep[i] = true;
+    }
+  }
+  return keep;
+}
+
+inline std::vector<bool> first_unique(
+    const std::vector<std::size_t>& left_groups,
+    const std::vector<std::size_t>& right_groups
+) {
+  return first_unique(left_groups, right_groups, std::vector<bool>(left_groups.size()));
+}
+
+template <typename Item>
+struct bulk_order {
+  std::vector<Item*> left_;
+  std::vector<Item*> right_;
+  std::vector<Item*> dropped_;
+};
+
+// sorts items for both indexes, the dropped ones are left for the caller to destroy
+template <typename Item, typename LeftKey, typename RightKey, typename CompareLeft, typename CompareRight>
+bulk_order<Item> make_bulk_order(
+    const std::vector<Item*>& items,
+    LeftKey left_key,
+    RightKey right_key,
+    const CompareLeft& comp_left,
+    const CompareRight& comp_right
+) {
+  std::vector<std::size_t> by_left = stable_order(items, left_key, comp_left);
+  std::vector<std::size_t> by_right = stable_order(items, right_key, comp_right);
+  std::vector<bool> keep = first_unique(
+      key_groups(items, by_left, left_key, comp_left),
+      key_groups(items, by_right, right_key, comp_right)
+  );
+  bulk_order<Item> res;
+  std::size_t kept = std::count(keep.begin(), keep.end(), true);
+  res.left_.reserve(kept);
+  res.right_.reserve(kept);
+  res.dropped_.reserve(items.size() - kept);
+  for (std::size_t i = 0; i < items.size(); ++i) {
+    if (keep[by_left[i]]) {
+      res.left_.push_back(items[by_left[i]]);
+    }
+    if (keep[by_right[i]]) {
+      res.right_.push_back(items[by_right[i]]);
+    }
+    if (!keep[i]) {
+      res.dropped_.push_back(items[i]);
+    }
+  }
+  return res;
+}
+
+} // namespace bimap_components
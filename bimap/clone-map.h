@@ -0,0 +1,55 @@
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace bimap_components {
+
+// open-addressing map from the nodes of a container to their copies, sized once for the given count
+template <typename From, typename To>
+class clone_map {
+public:
+  explicit clone_map(std::size_t count)
+      : shift_(64 - std::countr_zero(std::bit_ceil(2 * count + 2)))
+      , slots_(std::size_t(1) << (64 - shift_), {nullptr, nullptr}) {}
+
+  void insert(const From* key, To* value) noexcept {
+    std::size_t i = index(key);
+    while (slots_[i].first != nullptr) {
+      i = (i + 1) & (slots_.size() - 1);
+    }
+    slots_[i] = {key, value};
+  }
+
+  To* at(const From* key) const noexcept {
+    std::size_t i = index(key);
+    while (slots_[i].first != key) {
+      i = (i + 1) & (slots_.size() - 1);
+    }
+    return slots_[i].second;
+  }
+
+  template <typename F>
+  void for_each_copy(F func) const {
+    for (const std::pair<const From*, To*>& slot : slots_) {
+      if (slot.first != nullptr) {
+        func(slot.second);
+      }
+    }
+  }
+
+private:
+  std::size_t index(const From* key) const noexcept {
+    std::uint64_t hash = static_cast<std::uint64_t>(reinterpret_cast<std::uintptr_t>(key)) * 0x9E3779B97F4A7C15ull;
+    return static_cast<std::size_t>(hash >> shift_);
+  }
+
+private:
+  int shift_;
+  std::vector<std::pair<const From*, To*>> slots_;
+};
+
+} // namespace bimap_components
@@ -0,0 +1,275 @@
+#pragma once
+
+#include "bimap.h"
+#include "epoch.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
+
+// bimap shared between lock-free readers and serialized writers.
+// readers work on the currently published version: an immutable base snapshot plus a small delta
+// of pairs added to it and pairs of it that were removed, the delta is consulted first.
+// insert and erase copy only the delta, which is folded into a fresh base once it outgrows about
+// sqrt(size) pairs, so a single write costs O(sqrt(n) log n) amortized. update applies arbitrary
+// changes to a full copy and costs O(n), it is meant for batches
+template <
+    typename Left,
+    typename Right,
+    typename CompareLeft = std::less<Left>,
+    typename CompareRight = std::less<Right>,
+    typename Storage = bimap_components::rb_tree_storage,
+    typename Allocator = std::allocator<std::pair<Left, Right>>>
+class concurrent_bimap {
+public:
+  using snapshot_type = bimap<Left, Right, CompareLeft, CompareRight, Storage, Allocator>;
+
+private:
+  // a base shared between versions, owned by the concurrent_bimap
+  struct version {
+    const snapshot_type* base_;
+    snapshot_type added_;
+    snapshot_type removed_;
+  };
+
+  // delta sizes below this are never folded
+  static constexpr std::size_t MIN_DELTA = 64;
+
+public:
+  // lookups in one published version
+  class view {
+  public:
+    std::optional<Right> find_left(const Left& key) const {
+      if (auto it = version_.added_.find_left(key); it != version_.added_.end_left()) {
+        return *it.flip();
+      }
+      if (version_.removed_.find_left(key) != version_.removed_.end_left()) {
+        return std::nullopt;
+      }
+      if (auto it = version_.base_->find_left(key); it != version_.base_->end_left()) {
+        return *it.flip();
+      }
+      return std::nullopt;
+    }
+
+    std::optional<Left> find_right(const Right& key) const {
+      if (auto it = version_.added_.find_right(key); it != version_.added_.end_right()) {
+        return *it.flip();
+      }
+      if (version_.removed_.find_right(key) != version_.removed_.end_right()) {
+        return std::nullopt;
+      }
+      if (auto it = version_.base_->find_right(key); it != version_.base_->end_right()) {
+        return *it.flip();
+      }
+      return std::nullopt;
+    }
+
+    Right at_left(const Left& key) const {
+      std::optional<Right> res = find_left(key);
+      if (!res) {
+        throw std::out_of_range("key is not contained in the container");
+      }
+      return std::move(*res);
+    }
+
+    Left at_right(const Right& key) const {
+      std::optional<Left> res = find_right(key);
+      if (!res) {
+        throw std::out_of_range("key is not contained in the container");
+      }
+      return std::move(*res);
+    }
+
+    std::size_t size() const noexcept {
+      return version_.base_->size() + version_.added_.size() - version_.removed_.size();
+    }
+
+    bool empty() const noexcept {
+      return size() == 0;
+    }
+
+  private:
+    friend concurrent_bimap;
+
+    explicit view(const version& v) noexcept
+        : version_(v) {}
+
+    const version& version_;
+  };
+
+private:
+  static bool delta_full(const version& v) noexcept {
+    std::size_t delta = v.added_.size() + v.removed_.size();
+    return delta > MIN_DELTA && delta * delta > v.base_->size();
+  }
+
+  // the base with the delta of v applied
+  static std::unique_ptr<snapshot_type> fold(const version& v) {
+    auto res = std::make_unique<snapshot_type>(*v.base_);
+    for (auto it = v.removed_.begin_left(); it != v.removed_.end_left(); ++it) {
+      res->erase_left(*it);
+    }
+    for (auto it = v.added_.begin_left(); it != v.added_.end_left(); ++it) {
+      res->insert(*it, *it.flip());
+    }
+    return res;
+  }
+
+  std::unique_ptr<version> make_version(const snapshot_type* base) const {
+    return std::unique_ptr<version>(new version{base, empty_, empty_});
+  }
+
+  // publishes next, optionally with a new base, and frees what no reader can still see
+  void publish(std::unique_ptr<version> next, std::unique_ptr<snapshot_type> next_base) {
+    const version* old = current_.load(std::memory_order_relaxed);
+    const snapshot_type* old_base = next_base ? base_ : nullptr;
+    if (next_base) {
+      base_ = next_base.release();
+    }
+    current_.store(next.release());
+    epochs_.synchronize();
+    delete old;
+    delete old_base;
+  }
+
+  // next is a modified copy of the current version
+  void publish_delta(std::unique_ptr<version> next) {
+    if (!delta_full(*next)) {
+      publish(std::move(next), nullptr);
+      return;
+    }
+    std::unique_ptr<snapshot_type> folded = fold(*next);
+    std::unique_ptr<version> flat = make_version(folded.get());
+    publish(std::move(flat), std::move(folded));
+  }
+
+  const version& current() const noexcept {
+    return *current_.load(std::memory_order_relaxed);
+  }
+
+public:
+  concurrent_bimap(
+      CompareLeft compare_left = CompareLeft(),
+      CompareRight compare_right = CompareRight(),
+      const Allocator& alloc = Allocator()
+  )
+      : empty_(std::move(compare_left), std::move(compare_right), alloc)
+      , base_(new snapshot_type(empty_))
+      , current_(make_version(base_).release()) {}
+
+  explicit concurrent_bimap(snapshot_type init)
+      : empty_(init)
+      , base_(new snapshot_type(std::move(init))) {
+    empty_.erase_left(empty_.begin_left(), empty_.end_left());
+    current_.store(make_version(base_).release(), std::memory_order_relaxed);
+  }
+
+  concurrent_bimap(const concurrent_bimap&) = delete;
+  concurrent_bimap& operator=(const concurrent_bimap&) = delete;
+
+  ~concurrent_bimap() {
+    delete current_.load(std::memory_order_relaxed);
+    delete base_;
+  }
+
+  // calls func on a view of the current version; the view must not outlive the call
+  template <typename F>
+  decltype(auto) read(F func) const {
+    bimap_components::epoch_guard guard(epochs_);
+    return func(view(*current_.load(std::memory_order_acquire)));
+  }
+
+  std::optional<Right> find_left(const Left& key) const {
+    return read([&key](const view& v) { return v.find_left(key); });
+  }
+
+  std::optional<Left> find_right(const Right& key) const {
+    return read([&key](const view& v) { return v.find_right(key); });
+  }
+
+  Right at_left(const Left& key) const {
+    return read([&key](const view& v) { return v.at_left(key); });
+  }
+
+  Left at_right(const Right& key) const {
+    return read([&key](const view& v) { return v.at_right(key); });
+  }
+
+  std::size_t size() const {
+    return read([](const view& v) { return v.size(); });
+  }
+
+  bool empty() const {
+    return size() == 0;
+  }
+
+  // applies func to a full copy of the current contents and publishes it, returns what func returned
+  template <typename F>
+  auto update(F func) {
+    std::lock_guard<std::mutex> lock(writer_mutex_);
+    std::unique_ptr<snapshot_type> next_base = fold(current());
+    std::unique_ptr<version> next = make_version(next_base.get());
+    if constexpr (std::is_void_v<std::invoke_result_t<F&, snapshot_type&>>) {
+      func(*next_base);
+      publish(std::move(next), std::move(next_base));
+    } else {
+      auto res = func(*next_base);
+      publish(std::move(next), std::move(next_base));
+      return res;
+    }
+  }
+
+  bool insert(Left left, Right right) {
+    std::lock_guard<std::mutex> lock(writer_mutex_);
+    view cur(current());
+    if (cur.find_left(left) || cur.find_right(right)) {
+      return false;
+    }
+    auto next = std::make_unique<version>(current());
+    next->added_.insert(std::move(left), std::move(right));
+    publish_delta(std::move(next));
+    return true;
+  }
+
+  bool erase_left(const Left& key) {
+    std::lock_guard<std::mutex> lock(writer_mutex_);
+    std::optional<Right> other = view(current()).find_left(key);
+    if (!other) {
+      return false;
+    }
+    auto next = std::make_unique<version>(current());
+    if (!next->added_.erase_left(key)) {
+      next->removed_.insert(key, std::move(*other));
+    }
+    publish_delta(std::move(next));
+    return true;
+  }
+
+  bool erase_right(const Right& key) {
+    std::lock_guard<std::mutex> lock(writer_mutex_);
+    std::optional<Left> other = view(current()).find_right(key);
+    if (!other) {
+      return false;
+    }
+    auto next = std::make_unique<version>(current());
+    if (!next->added_.erase_right(key)) {
+      next->removed_.insert(std::move(*other), key);
+    }
+    publish_delta(std::move(next));
+    return true;
+  }
+
+private:
+  // an empty bimap with the comparators and allocator of the contents, copied to start a delta
+  snapshot_type empty_;
+  const snapshot_type* base_;
+  std::atomic<const version*> current_;
+  mutable bimap_components::epoch_domain epochs_;
+  std::mutex writer_mutex_;
+};
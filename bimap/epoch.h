@@ -0,0 +1,82 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <thread>
+
+namespace bimap_components {
+
+// read-side critical sections for publish-then-reclaim updates:
+// readers only touch a counter of their own stripe, a writer flips the epoch
+// and waits until every reader that entered under the previous one has left
+class epoch_domain {
+  static constexpr std::size_t STRIPES = 64;
+
+  struct alignas(64) stripe {
+    std::atomic<std::size_t> readers_[2] = {0, 0};
+  };
+
+  static std::size_t stripe_index() noexcept {
+    static std::atomic<std::size_t> next_index(0);
+    thread_local std::size_t index = next_index.fetch_add(1, std::memory_order_relaxed) % STRIPES;
+    return index;
+  }
+
+public:
+  epoch_domain() noexcept
+      : epoch_(0) {}
+
+  epoch_domain(const epoch_domain&) = delete;
+  epoch_domain& operator=(const epoch_domain&) = delete;
+
+  // returns the epoch to be passed to leave
+  std::size_t enter() noexcept {
+    stripe& st = stripes_[stripe_index()];
+    while (true) {
+      std::size_t epoch = epoch_.load();
+      st.readers_[epoch & 1].fetch_add(1);
+      if (epoch_.load() == epoch) {
+        return epoch;
+      }
+      st.readers_[epoch & 1].fetch_sub(1, std::memory_order_release);
+    }
+  }
+
+  void leave(std::size_t epoch) noexcept {
+    stripes_[stripe_index()].readers_[epoch & 1].fetch_sub(1, std::memory_order_release);
+  }
+
+  // returns once no reader can still observe anything unpublished before the call
+  void synchronize() noexcept {
+    std::size_t epoch = epoch_.fetch_add(1);
+    for (stripe& st : stripes_) {
+      while (st.readers_[epoch & 1].load() != 0) {
+        std::this_thread::yield();
+      }
+    }
+  }
+
+private:
+  std::atomic<std::size_t> epoch_;
+  stripe stripes_[STRIPES];
+};
+
+class epoch_guard {
+public:
+  explicit epoch_guard(epoch_domain& domain) noexcept
+      : domain_(domain)
+      , epoch_(domain.enter()) {}
+
+  epoch_guard(const epoch_guard&) = delete;
+  epoch_guard& operator=(const epoch_guard&) = delete;
+
+  ~epoch_guard() {
+    domain_.leave(epoch_);
+  }
+
+private:
+  epoch_domain& domain_;
+  std::size_t epoch_;
+};
+
+} // namespace bimap_components
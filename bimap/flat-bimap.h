@@ -0,0 +1,730 @@
+#pragma once
+
+#include "bulk-load.h"
+#include "nodes.h"
+
+#include <algorithm>
+#include <compare>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+template <typename Left, typename Right, typename CompareLeft, typename CompareRight>
+class flat_bimap;
+
+namespace bimap_components {
+
+// lower_bound over a sorted array: the loop always runs bit_width(n) - 1 times
+// and the comparison only selects the next base, so it compiles to a conditional move
+template <typename T, typename K, typename Compare>
+std::size_t branchless_lower_bound(const T* data, std::size_t n, const K& key, const Compare& comp) {
+  if (n == 0) {
+    return 0;
+  }
+  const T* base = data;
+  while (n > 1) {
+    std::size_t half = n / 2;
+    base = comp(base[half], key) ? base + half : base;
+    n -= half;
+  }
+  return static_cast<std::size_t>(base - data) + static_cast<std::size_t>(comp(*base, key));
+}
+
+// keys of each side sorted by their comparator, links_ of a side hold the position
+// of the same pair on the other side
+template <typename Left, typename Right>
+struct flat_storage {
+  template <typename Tag>
+  const auto& keys() const noexcept {
+    if constexpr (std::is_same_v<Tag, tag_left>) {
+      return lefts_;
+    } else {
+      return rights_;
+    }
+  }
+
+  template <typename Tag>
+  const std::vector<std::size_t>& links() const noexcept {
+    if constexpr (std::is_same_v<Tag, tag_left>) {
+      return left_links_;
+    } else {
+      return right_links_;
+    }
+  }
+
+  std::vector<Left> lefts_;
+  std::vector<std::size_t> left_links_;
+  std::vector<Right> rights_;
+  std::vector<std::size_t> right_links_;
+};
+
+template <typename T, typename Other, typename Tag>
+class flat_iterator {
+  using Left = std::conditional_t<std::is_same_v<Tag, tag_left>, T, Other>;
+  using Right = std::conditional_t<std::is_same_v<Tag, tag_left>, Other, T>;
+  using OtherTag = std::conditional_t<std::is_same_v<Tag, tag_left>, tag_right, tag_left>;
+  using OtherIterator = flat_iterator<Other, T, OtherTag>;
+  using Storage = flat_storage<Left, Right>;
+
+public:
+  using difference_type = std::ptrdiff_t;
+  using value_type = T;
+  using pointer = const T*;
+  using reference = const T&;
+  using iterator_category = std::random_access_iterator_tag;
+
+private:
+  template <typename L, typename R, typename CL, typename CR>
+  friend class ::flat_bimap;
+
+  template <typename Y, typename OtherY, typename Tg>
+  friend class flat_iterator;
+
+  flat_iterator(const Storage* storage, const T* cur) noexcept
+      : storage_(storage)
+      , cur_(cur) {}
+
+  std::size_t index() const noexcept {
+    return static_cast<std::size_t>(cur_ - storage_->template keys<Tag>().data());
+  }
+
+public:
+  flat_iterator() noexcept
+      : storage_(nullptr)
+      , cur_(nullptr) {}
+
+  reference operator*() const noexcept {
+    return *cur_;
+  }
+
+  pointer operator->() const noexcept {
+    return cur_;
+  }
+
+  reference operator[](difference_type n) const noexcept {
+    return cur_[n];
+  }
+
+  flat_iterator& operator++() noexcept {
+    ++cur_;
+    return *this;
+  }
+
+  flat_iterator operator++(int) noexcept {
+    flat_iterator tmp = *this;
+    ++*this;
+    return tmp;
+  }
+
+  flat_iterator& operator--() noexcept {
+    --cur_;
+    return *this;
+  }
+
+  flat_iterator operator--(int) noexcept {
+    flat_iterator tmp = *this;
+    --*this;
+    return tmp;
+  }
+
+  flat_iterator& operator+=(difference_type n) noexcept {
+    cur_ += n;
+    return *this;
+  }
+
+  flat_iterator& operator-=(difference_type n) noexcept {
+    cur_ -= n;
+    return *this;
+  }
+
+  friend flat_iterator operator+(flat_iterator it, difference_type n) noexcept {
+    return it += n;
+  }
+
+  friend flat_iterator operator+(difference_type n, flat_iterator it) noexcept {
+    return it += n;
+  }
+
+  friend flat_iterator operator-(flat_iterator it, difference_type n) noexcept {
+    return it -= n;
+  }
+
+  friend difference_type operator-(const flat_iterator& lhs, const flat_iterator& rhs) noexcept {
+    return lhs.cur_ - rhs.cur_;
+  }
+
+  OtherIterator flip() const noexcept {
+    const auto& other_keys = storage_->template keys<OtherTag>();
+    if (cur_ == storage_->template keys<Tag>().data() + storage_->template keys<Tag>().size()) {
+      return {storage_, other_keys.data() + other_keys.size()};
+    }
+    return {storage_, other_keys.data() + storage_->template links<Tag>()[index()]};
+  }
+
+  friend bool operator==(const flat_iterator& lhs, const flat_iterator& rhs) noexcept {
+    return lhs.cur_ == rhs.cur_;
+  }
+
+  friend bool operator!=(const flat_iterator& lhs, const flat_iterator& rhs) noexcept {
+    return !(lhs == rhs);
+  }
+
+  friend std::strong_ordering operator<=>(const flat_iterator& lhs, const flat_iterator& rhs) noexcept {
+    return std::compare_three_way()(lhs.cur_, rhs.cur_);
+  }
+
+private:
+  const Storage* storage_;
+  const T* cur_;
+};
+
+} // namespace bimap_components
+
+// bimap for tables that are built once and mostly read: keys of each side lie in a contiguous
+// sorted array searched without branches, the pairs are joined by position indexes.
+// Insertions and erasures shift both arrays and cost O(n)
+template <
+    typename Left,
+    typename Right,
+    typename CompareLeft = std::less<Left>,
+    typename CompareRight = std::less<Right>>
+class flat_bimap {
+  using Storage = bimap_components::flat_storage<Left, Right>;
+
+public:
+  using left_iterator = bimap_components::flat_iterator<Left, Right, bimap_components::tag_left>;
+
+  using right_iterator = bimap_components::flat_iterator<Right, Left, bimap_components::tag_right>;
+
+private:
+  template <typename Tag>
+  using tag_type_v = std::conditional_t<std::is_same_v<Tag, bimap_components::tag_left>, Left, Right>;
+
+  template <typename Tag>
+  using tag_other_v = std::conditional_t<
+      std::is_same_v<Tag, bimap_components::tag_left>,
+      bimap_components::tag_right,
+      bimap_components::tag_left>;
+
+  template <typename Tag>
+  using base_iterator =
+      std::conditional_t<std::is_same_v<Tag, bimap_components::tag_left>, left_iterator, right_iterator>;
+
+  template <typename Tag>
+  const auto& comp() const noexcept {
+    if constexpr (std::is_same_v<Tag, bimap_components::tag_left>) {
+      return comp_left_;
+    } else {
+      return comp_right_;
+    }
+  }
+
+  template <typename Tag>
+  base_iterator<Tag> iterator_at(std::size_t index) const noexcept {
+    return {&storage_, storage_.template keys<Tag>().data() + index};
+  }
+
+  template <typename Tag, typename K>
+  std::size_t lower_index(const K& key) const {
+    const std::vector<tag_type_v<Tag>>& keys = storage_.template keys<Tag>();
+    return bimap_components::branchless_lower_bound(keys.data(), keys.size(), key, comp<Tag>());
+  }
+
+  // size() if key is not contained
+  template <typename Tag, typename K>
+  std::size_t find_index(const K& key) const {
+    std::size_t index = lower_index<Tag>(key);
+    const std::vector<tag_type_v<Tag>>& keys = storage_.template keys<Tag>();
+    if (index != keys.size() && comp<Tag>()(key, keys[index])) {
+      return keys.size();
+    }
+    return index;
+  }
+
+  template <typename Tag, typename K>
+  base_iterator<Tag> lower_bound(const K& key) const {
+    return iterator_at<Tag>(lower_index<Tag>(key));
+  }
+
+  template <typename Tag, typename K>
+  base_iterator<Tag> upper_bound(const K& key) const {
+    std::size_t index = lower_index<Tag>(key);
+    const std::vector<tag_type_v<Tag>>& keys = storage_.template keys<Tag>();
+    if (index != keys.size() && !comp<Tag>()(key, keys[index])) {
+      ++index;
+    }
+    return iterator_at<Tag>(index);
+  }
+
+  template <typename Tag, typename K>
+  base_iterator<Tag> find(const K& key) const {
+    return iterator_at<Tag>(find_index<Tag>(key));
+  }
+
+  template <typename Tag, typename K>
+  const tag_type_v<tag_other_v<Tag>>& at_other(const K& key) const {
+    std::size_t index = find_index<Tag>(key);
+    if (index == size()) {
+      throw std::out_of_range("key is not contained in the container");
+    }
+    return storage_.template keys<tag_other_v<Tag>>()[storage_.template links<Tag>()[index]];
+  }
+
+  template <typename Tag>
+  std::size_t left_index(std::size_t index) const noexcept {
+    if constexpr (std::is_same_v<Tag, bimap_components::tag_left>) {
+      return index;
+    } else {
+      return storage_.right_links_[index];
+    }
+  }
+
+  // makes room for one more element with a geometric growth, so the insertions
+  // of indexes after the keys are in place cannot throw
+  template <typename T>
+  static void grow(std::vector<T>& data) {
+    if (data.size() == data.capacity()) {
+      data.reserve(2 * data.size() + 1);
+    }
+  }
+
+  // pl and pr are the lower bounds of left and right
+  template <typename L, typename R>
+  left_iterator insert_at(std::size_t pl, std::size_t pr, L&& left, R&& right) {
+    grow(storage_.lefts_);
+    grow(storage_.left_links_);
+    grow(storage_.rights_);
+    grow(storage_.right_links_);
+    storage_.lefts_.insert(storage_.lefts_.begin() + pl, std::forward<L>(left));
+    try {
+      storage_.rights_.insert(storage_.rights_.begin() + pr, std::forward<R>(right));
+    } catch (...) {
+      storage_.lefts_.erase(storage_.lefts_.begin() + pl);
+      throw;
+    }
+    for (std::size_t& link : storage_.left_links_) {
+      link += link >= pr;
+    }
+    for (std::size_t& link : storage_.right_links_) {
+      link += link >= pl;
+    }
+    storage_.left_links_.insert(storage_.left_links_.begin() + pl, pr);
+    storage_.right_links_.insert(storage_.right_links_.begin() + pr, pl);
+    return iterator_at<bimap_components::tag_left>(pl);
+  }
+
+  template <typename L, typename R>
+  left_iterator base_insert(L&& left, R&& right) {
+    std::size_t pl = lower_index<bimap_components::tag_left>(left);
+    std::size_t pr = lower_index<bimap_components::tag_right>(right);
+    if ((pl != size() && !comp_left_(left, storage_.lefts_[pl])) ||
+        (pr != size() && !comp_right_(right, storage_.rights_[pr]))) {
+      return end_left();
+    }
+    return insert_at(pl, pr, std::forward<L>(left), std::forward<R>(right));
+  }
+
+  void erase_entry(std::size_t pl) {
+    std::size_t pr = storage_.left_links_[pl];
+    storage_.lefts_.erase(storage_.lefts_.begin() + pl);
+    storage_.rights_.erase(storage_.rights_.begin() + pr);
+    storage_.left_links_.erase(storage_.left_links_.begin() + pl);
+    storage_.right_links_.erase(storage_.right_links_.begin() + pr);
+    for (std::size_t& link : storage_.left_links_) {
+      link -= link > pr;
+    }
+    for (std::size_t& link : storage_.right_links_) {
+      link -= link > pl;
+    }
+  }
+
+  // removes every pair whose left position is marked, compacting both sides in one pass
+  void erase_marked(const std::vector<bool>& removed_left) {
+    std::size_t n = size();
+    std::vector<std::size_t> new_left(n);
+    std::vector<std::size_t> new_right(n);
+    for (std::size_t i = 0, kept = 0; i < n; ++i) {
+      new_left[i] = kept;
+      kept += !removed_left[i];
+    }
+    for (std::size_t j = 0, kept = 0; j < n; ++j) {
+      new_right[j] = kept;
+      kept += !removed_left[storage_.right_links_[j]];
+    }
+    std::size_t kept = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+      if (!removed_left[i]) {
+        // self-move assignment empties std::string and std::vector, skip the untouched prefix
+        if (kept != i) {
+          storage_.lefts_[kept] = std::move(storage_.lefts_[i]);
+        }
+        storage_.left_links_[kept] = new_right[storage_.left_links_[i]];
+        ++kept;
+      }
+    }
+    kept = 0;
+    for (std::size_t j = 0; j < n; ++j) {
+      if (!removed_left[storage_.right_links_[j]]) {
+        if (kept != j) {
+          storage_.rights_[kept] = std::move(storage_.rights_[j]);
+        }
+        storage_.right_links_[kept] = new_left[storage_.right_links_[j]];
+        ++kept;
+      }
+    }
+    storage_.lefts_.erase(storage_.lefts_.begin() + kept, storage_.lefts_.end());
+    storage_.left_links_.resize(kept);
+    storage_.rights_.erase(storage_.rights_.begin() + kept, storage_.rights_.end());
+    storage_.right_links_.resize(kept);
+  }
+
+  template <typename Tag>
+  base_iterator<Tag> erase_iterator(base_iterator<Tag> it) {
+    std::size_t index = it.index();
+    erase_entry(left_index<Tag>(index));
+    return iterator_at<Tag>(index);
+  }
+
+  template <typename Tag>
+  base_iterator<Tag> erase_range(base_iterator<Tag> first, base_iterator<Tag> last) {
+    std::size_t from = first.index();
+    std::size_t to = last.index();
+    std::vector<bool> removed(size());
+    for (std::size_t i = from; i < to; ++i) {
+      removed[left_index<Tag>(i)] = true;
+    }
+    erase_marked(removed);
+    return iterator_at<Tag>(from);
+  }
+
+  template <typename Tag, typename K>
+  bool erase_value(const K& key) {
+    std::size_t index = find_index<Tag>(key);
+    if (index == size()) {
+      return false;
+    }
+    erase_entry(left_index<Tag>(index));
+    return true;
+  }
+
+  template <typename Tag>
+  const tag_type_v<tag_other_v<Tag>>& at_other_or_default(const tag_type_v<Tag>& key) {
+    std::size_t index = find_index<Tag>(key);
+    if (index != size()) {
+      return storage_.template keys<tag_other_v<Tag>>()[storage_.template links<Tag>()[index]];
+    }
+    // both keys are built before the pair holding the default is erased, so a throwing copy changes nothing
+    auto key_copy = tag_type_v<Tag>(key);
+    auto default_value = tag_type_v<tag_other_v<Tag>>();
+    std::size_t other_index = find_index<tag_other_v<Tag>>(default_value);
+    if (other_index != size()) {
+      erase_entry(left_index<tag_other_v<Tag>>(other_index));
+    }
+    if constexpr (std::is_same_v<Tag, bimap_components::tag_left>) {
+      return *insert(std::move(key_copy), std::move(default_value)).flip();
+    } else {
+      return *insert(std::move(default_value), std::move(key_copy));
+    }
+  }
+
+public:
+  flat_bimap(CompareLeft compare_left = CompareLeft(), CompareRight compare_right = CompareRight())
+      : comp_left_(std::move(compare_left))
+      , comp_right_(std::move(compare_right)) {}
+
+  template <std::input_iterator It>
+  flat_bimap(
+      It first,
+      It last,
+      CompareLeft compare_left = CompareLeft(),
+      CompareRight compare_right = CompareRight()
+  )
+      : flat_bimap(std::move(compare_left), std::move(compare_right)) {
+    assign(first, last);
+  }
+
+  // replaces the content with the pairs that inserting the range one by one would keep
+  template <std::input_iterator It>
+  void assign(It first, It last) {
+    std::vector<std::pair<Left, Right>> items;
+    for (; first != last; ++first) {
+      auto&& pair = *first;
+      items.emplace_back(
+          std::get<0>(std::forward<decltype(pair)>(pair)),
+          std::get<1>(std::forward<decltype(pair)>(pair))
+      );
+    }
+    std::vector<std::pair<Left, Right>*> pointers(items.size());
+    for (std::size_t i = 0; i < items.size(); ++i) {
+      pointers[i] = &items[i];
+    }
+    bimap_components::bulk_order<std::pair<Left, Right>> order = bimap_components::make_bulk_order(
+        pointers,
+        [](std::pair<Left, Right>* item) -> const Left& { return item->first; },
+        [](std::pair<Left, Right>* item) -> const Right& { return item->second; },
+        comp_left_,
+        comp_right_
+    );
+    std::size_t n = order.left_.size();
+    std::vector<std::size_t> right_position(items.size());
+    for (std::size_t j = 0; j < n; ++j) {
+      right_position[order.right_[j] - items.data()] = j;
+    }
+    Storage storage;
+    storage.lefts_.reserve(n);
+    storage.left_links_.reserve(n);
+    storage.rights_.reserve(n);
+    storage.right_links_.resize(n);
+    for (std::size_t i = 0; i < n; ++i) {
+      std::size_t j = right_position[order.left_[i] - items.data()];
+      storage.lefts_.push_back(std::move(order.left_[i]->first));
+      storage.left_links_.push_back(j);
+      storage.right_links_[j] = i;
+    }
+    for (std::size_t j = 0; j < n; ++j) {
+      storage.rights_.push_back(std::move(order.right_[j]->second));
+    }
+    storage_ = std::move(storage);
+  }
+
+  void reserve(std::size_t capacity) {
+    storage_.lefts_.reserve(capacity);
+    storage_.left_links_.reserve(capacity);
+    storage_.rights_.reserve(capacity);
+    storage_.right_links_.reserve(capacity);
+  }
+
+  friend void swap(flat_bimap& l, flat_bimap& r) noexcept {
+    using std::swap;
+    swap(l.comp_left_, r.comp_left_);
+    swap(l.comp_right_, r.comp_right_);
+    swap(l.storage_, r.storage_);
+  }
+
+  left_iterator insert(const Left& left, const Right& right) {
+    return base_insert(left, right);
+  }
+
+  left_iterator insert(const Left& left, Right&& right) {
+    return base_insert(left, std::move(right));
+  }
+
+  left_iterator insert(Left&& left, const Right& right) {
+    return base_insert(std::move(left), right);
+  }
+
+  left_iterator insert(Left&& left, Right&& right) {
+    return base_insert(std::move(left), std::move(right));
+  }
+
+  left_iterator erase_left(left_iterator it) {
+    return erase_iterator<bimap_components::tag_left>(it);
+  }
+
+  right_iterator erase_right(right_iterator it) {
+    return erase_iterator<bimap_components::tag_right>(it);
+  }
+
+  bool erase_left(const Left& left) {
+    return erase_value<bimap_components::tag_left>(left);
+  }
+
+  template <typename K>
+    requires bimap_components::transparent<CompareLeft> && (!std::is_convertible_v<const K&, left_iterator>)
+  bool erase_left(const K& left) {
+    return erase_value<bimap_components::tag_left>(left);
+  }
+
+  bool erase_right(const Right& right) {
+    return erase_value<bimap_components::tag_right>(right);
+  }
+
+  template <typename K>
+    requires bimap_components::transparent<CompareRight> && (!std::is_convertible_v<const K&, right_iterator>)
+  bool erase_right(const K& right) {
+    return erase_value<bimap_components::tag_right>(right);
+  }
+
+  left_iterator erase_left(left_iterator first, left_iterator last) {
+    return erase_range<bimap_components::tag_left>(first, last);
+  }
+
+  right_iterator erase_right(right_iterator first, right_iterator last) {
+    return erase_range<bimap_components::tag_right>(first, last);
+  }
+
+  left_iterator find_left(const Left& left) const {
+    return find<bimap_components::tag_left>(left);
+  }
+
+  template <typename K>
+    requires bimap_components::transparent<CompareLeft>
+  left_iterator find_left(const K& left) const {
+    return find<bimap_components::tag_left>(left);
+  }
+
+  right_iterator find_right(const Right& right) const {
+    return find<bimap_components::tag_right>(right);
+  }
+
+  template <typename K>
+    requires bimap_components::transparent<CompareRight>
+  right_iterator find_right(const K& right) const {
+    return find<bimap_components::tag_right>(right);
+  }
+
+  const Right& at_left(const Left& key) const {
+    return at_other<bimap_components::tag_left>(key);
+  }
+
+  template <typename K>
+    requires bimap_components::transparent<CompareLeft>
+  const Right& at_left(const K& key) const {
+    return at_other<bimap_components::tag_left>(key);
+  }
+
+  const Left& at_right(const Right& key) const {
+    return at_other<bimap_components::tag_right>(key);
+  }
+
+  template <typename K>
+    requires bimap_components::transparent<CompareRight>
+  const Left& at_right(const K& key) const {
+    return at_other<bimap_components::tag_right>(key);
+  }
+
+  const Right& at_left_or_default(const Left& key)
+    requires std::is_default_constructible_v<Right>
+  {
+    return at_other_or_default<bimap_components::tag_left>(key);
+  }
+
+  const Left& at_right_or_default(const Right& key)
+    requires std::is_default_constructible_v<Left>
+  {
+    return at_other_or_default<bimap_components::tag_right>(key);
+  }
+
+  left_iterator lower_bound_left(const Left& left) const {
+    return lower_bound<bimap_components::tag_left>(left);
+  }
+
+  template <typename K>
+    requires bimap_components::transparent<CompareLeft>
+  left_iterator lower_bound_left(const K& left) const {
+    return lower_bound<bimap_components::tag_left>(left);
+  }
+
+  left_iterator upper_bound_left(const Left& left) const {
+    return upper_bound<bimap_components::tag_left>(left);
+  }
+
+  template <typename K>
+    requires bimap_components::transparent<CompareLeft>
+  left_iterator upper_bound_left(const K& left) const {
+    return upper_bound<bimap_components::tag_left>(left);
+  }
+
+  right_iterator lower_bound_right(const Right& right) const {
+    return lower_bound<bimap_components::tag_right>(right);
+  }
+
+  template <typename K>
+    requires bimap_components::transparent<CompareRight>
+  right_iterator lower_bound_right(const K& right) const {
+    return lower_bound<bimap_components::tag_right>(right);
+  }
+
+  right_iterator upper_bound_right(const Right& right) const {
+    return upper_bound<bimap_components::tag_right>(right);
+  }
+
+  template <typename K>
+    requires bimap_components::transparent<CompareRight>
+  right_iterator upper_bound_right(const K& right) const {
+    return upper_bound<bimap_components::tag_right>(right);
+  }
+
+  left_iterator nth_left(std::size_t k) const noexcept {
+    return iterator_at<bimap_components::tag_left>(std::min(k, size()));
+  }
+
+  right_iterator nth_right(std::size_t k) const noexcept {
+    return iterator_at<bimap_components::tag_right>(std::min(k, size()));
+  }
+
+  std::size_t rank_left(const Left& left) const {
+    return lower_index<bimap_components::tag_left>(left);
+  }
+
+  template <typename K>
+    requires bimap_components::transparent<CompareLeft>
+  std::size_t rank_left(const K& left) const {
+    return lower_index<bimap_components::tag_left>(left);
+  }
+
+  std::size_t rank_right(const Right& right) const {
+    return lower_index<bimap_components::tag_right>(right);
+  }
+
+  template <typename K>
+    requires bimap_components::transparent<CompareRight>
+  std::size_t rank_right(const K& right) const {
+    return lower_index<bimap_components::tag_right>(right);
+  }
+
+  left_iterator begin_left() const noexcept {
+    return iterator_at<bimap_components::tag_left>(0);
+  }
+
+  left_iterator end_left() const noexcept {
+    return iterator_at<bimap_components::tag_left>(size());
+  }
+
+  right_iterator begin_right() const noexcept {
+    return iterator_at<bimap_components::tag_right>(0);
+  }
+
+  right_iterator end_right() const noexcept {
+    return iterator_at<bimap_components::tag_right>(size());
+  }
+
+  bool empty() const noexcept {
+    return size() == 0;
+  }
+
+  std::size_t size() const noexcept {
+    return storage_.lefts_.size();
+  }
+
+  friend bool operator==(const flat_bimap& l, const flat_bimap& r) {
+    if (l.size() != r.size()) {
+      return false;
+    }
+    for (std::size_t i = 0; i < l.size(); ++i) {
+      const Left& left_l = l.storage_.lefts_[i];
+      const Left& left_r = r.storage_.lefts_[i];
+      const Right& right_l = l.storage_.rights_[l.storage_.left_links_[i]];
+      const Right& right_r = r.storage_.rights_[r.storage_.left_links_[i]];
+      if (l.comp_left_(left_l, left_r) || l.comp_left_(left_r, left_l) || l.comp_right_(right_l, right_r) ||
+          l.comp_right_(right_r, right_l)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  friend bool operator!=(const flat_bimap& l, const flat_bimap& r) {
+    return !(l == r);
+  }
+
+private:
+  Storage storage_;
+  [[no_unique_address]] CompareLeft comp_left_;
+  [[no_unique_address]] CompareRight comp_right_;
+};
@@ -5,7 +5,7 @@
 #include <iterator>
 #include <type_traits>
 
-template <typename T, typename Other, typename CompareLeft, typename CompareRight>
+template <typename T, typename Other, typename CompareLeft, typename CompareRight, typename Storage, typename Allocator>
 class bimap;
 
 namespace bimap_components {
@@ -31,7 +31,7 @@ private:
   template <typename Y, typename OtherY, typename C, typename Tg>
   friend class map;
 
-  template <typename Y, typename OtherY, typename CL, typename CR>
+  template <typename Y, typename OtherY, typename CL, typename CR, typename S, typename A>
   friend class ::bimap;
 
   template <typename Y, typename OtherY, typename Tg>
@@ -82,6 +82,31 @@ public:
     return tmp;
   }
 
+  base_iterator& operator+=(difference_type n) noexcept {
+    nd_ = nd_->advance(n);
+    return *this;
+  }
+
+  base_iterator& operator-=(difference_type n) noexcept {
+    return *this += -n;
+  }
+
+  friend base_iterator operator+(base_iterator it, difference_type n) noexcept {
+    return it += n;
+  }
+
+  friend base_iterator operator+(difference_type n, base_iterator it) noexcept {
+    return it += n;
+  }
+
+  friend base_iterator operator-(base_iterator it, difference_type n) noexcept {
+    return it -= n;
+  }
+
+  friend difference_type operator-(const base_iterator& lhs, const base_iterator& rhs) noexcept {
+    return static_cast<difference_type>(lhs.nd_->get_rank()) - static_cast<difference_type>(rhs.nd_->get_rank());
+  }
+
   OtherIterator flip() const noexcept {
     return {static_cast<base_node<OtherTag>*>(static_cast<bimap_node*>(nd_))};
   }
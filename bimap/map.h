@@ -2,6 +2,7 @@
 
 #include "iterator.h"
 
+#include <bit>
 #include <stdexcept>
 
 namespace bimap_components {
@@ -47,29 +48,184 @@ private:
     return (nd->p_->l_ == nd ? nd->p_->l_ : nd->p_->r_);
   }
 
-  void unlink(node* nd) noexcept {
-    if (nd == get_max()) {
-      sentinel_->l_ = nd->get_prev();
+  void transplant(node* nd, node* replacement) noexcept {
+    get_parent_ptr(nd) = replacement;
+    if (replacement != nullptr) {
+      replacement->p_ = nd->p_;
     }
-    if (nd == get_min()) {
-      sentinel_->r_ = nd->get_next();
+  }
+
+  void rotate_left(node* nd) noexcept {
+    node* child = nd->r_;
+    nd->r_ = child->l_;
+    if (child->l_ != nullptr) {
+      child->l_->p_ = nd;
     }
-    if (nd->r_ == nullptr && nd->l_ == nullptr) {
-      get_parent_ptr(nd) = nullptr;
-    } else if (nd->r_ == nullptr) {
-      get_parent_ptr(nd) = nd->l_;
-      nd->l_->p_ = nd->p_;
-    } else {
-      get_parent_ptr(nd) = nd->r_;
-      nd->r_->p_ = nd->p_;
+    transplant(nd, child);
+    child->l_ = nd;
+    nd->p_ = child;
+    child->size_ = nd->size_;
+    nd->update_size();
+  }
+
+  void rotate_right(node* nd) noexcept {
+    node* child = nd->l_;
+    nd->l_ = child->r_;
+    if (child->r_ != nullptr) {
+      child->r_->p_ = nd;
+    }
+    transplant(nd, child);
+    child->r_ = nd;
+    nd->p_ = child;
+    child->size_ = nd->size_;
+    nd->update_size();
+  }
+
+  // restores red-black properties after attaching red leaf nd
+  void insert_fixup(node* nd) noexcept {
+    while (nd != get_root() && node::is_red(nd->p_)) {
+      node* parent = nd->p_;
+      node* grand = parent->p_;
+      if (parent == grand->l_) {
+        node* uncle = grand->r_;
+        if (node::is_red(uncle)) {
+          parent->red_ = false;
+          uncle->red_ = false;
+          grand->red_ = true;
+          nd = grand;
+          continue;
+        }
+        if (nd == parent->r_) {
+          rotate_left(parent);
+          std::swap(nd, parent);
+        }
+        parent->red_ = false;
+        grand->red_ = true;
+        rotate_right(grand);
+      } else {
+        node* uncle = grand->l_;
+        if (node::is_red(uncle)) {
+          parent->red_ = false;
+          uncle->red_ = false;
+          grand->red_ = true;
+          nd = grand;
+          continue;
+        }
+        if (nd == parent->l_) {
+          rotate_right(parent);
+          std::swap(nd, parent);
+        }
+        parent->red_ = false;
+        grand->red_ = true;
+        rotate_left(grand);
+      }
+    }
+    get_root()->red_ = false;
+  }
+
+  // nd may be nullptr, so its parent is passed explicitly
+  void erase_fixup(node* nd, node* parent) noexcept {
+    while (nd != get_root() && !node::is_red(nd)) {
+      if (nd == parent->l_) {
+        node* sibling = parent->r_;
+        if (sibling->red_) {
+          sibling->red_ = false;
+          parent->red_ = true;
+          rotate_left(parent);
+          sibling = parent->r_;
+        }
+        if (!node::is_red(sibling->l_) && !node::is_red(sibling->r_)) {
+          sibling->red_ = true;
+          nd = parent;
+          parent = nd->p_;
+          continue;
+        }
+        if (!node::is_red(sibling->r_)) {
+          sibling->l_->red_ = false;
+          sibling->red_ = true;
+          rotate_right(sibling);
+          sibling = parent->r_;
+        }
+        sibling->red_ = parent->red_;
+        parent->red_ = false;
+        sibling->r_->red_ = false;
+        rotate_left(parent);
+      } else {
+        node* sibling = parent->l_;
+        if (sibling->red_) {
+          sibling->red_ = false;
+          parent->red_ = true;
+          rotate_right(parent);
+          sibling = parent->l_;
+        }
+        if (!node::is_red(sibling->l_) && !node::is_red(sibling->r_)) {
+          sibling->red_ = true;
+          nd = parent;
+          parent = nd->p_;
+          continue;
+        }
+        if (!node::is_red(sibling->l_)) {
+          sibling->r_->red_ = false;
+          sibling->red_ = true;
+          rotate_left(sibling);
+          sibling = parent->l_;
+        }
+        sibling->red_ = parent->red_;
+        parent->red_ = false;
+        sibling->l_->red_ = false;
+        rotate_right(parent);
+      }
+      nd = get_root();
+    }
+    if (nd != nullptr) {
+      nd->red_ = false;
     }
   }
 
+  static node* build_subtree(
+      value_node<Left, Right>* const* nodes,
+      std::size_t count,
+      std::size_t depth,
+      std::size_t red_depth
+  ) noexcept {
+    if (count == 0) {
+      return nullptr;
+    }
+    std::size_t mid = count / 2;
+    node* nd = nodes[mid];
+    nd->red_ = depth == red_depth && depth != 0;
+    nd->size_ = count;
+    nd->l_ = build_subtree(nodes, mid, depth + 1, red_depth);
+    nd->r_ = build_subtree(nodes + mid + 1, count - mid - 1, depth + 1, red_depth);
+    if (nd->l_ != nullptr) {
+      nd->l_->p_ = nd;
+    }
+    if (nd->r_ != nullptr) {
+      nd->r_->p_ = nd;
+    }
+    return nd;
+  }
+
+  void attach(node* ins, node* parent, node*& link) noexcept {
+    ins->l_ = nullptr;
+    ins->r_ = nullptr;
+    ins->p_ = parent;
+    ins->red_ = true;
+    ins->size_ = 1;
+    link = ins;
+    for (node* nd = parent; nd != sentinel_; nd = nd->p_) {
+      nd->size_++;
+    }
+    insert_fixup(ins);
+  }
+
 public:
   void move_node(node* nd, node* dist) const noexcept {
     dist->l_ = nd->l_;
     dist->r_ = nd->r_;
     dist->p_ = nd->p_;
+    dist->red_ = nd->red_;
+    dist->size_ = nd->size_;
     if (dist->l_ != nullptr) {
       dist->l_->p_ = dist;
     }
@@ -95,26 +251,46 @@ public:
 
   iterator erase(node* nd) noexcept {
     node* res = nd->get_next();
-    if (nd->r_ == nullptr || nd->l_ == nullptr) {
-      unlink(nd);
+    if (nd == get_max()) {
+      sentinel_->l_ = nd->get_prev();
+    }
+    if (nd == get_min()) {
+      sentinel_->r_ = res;
+    }
+    node* removed = (nd->l_ == nullptr || nd->r_ == nullptr) ? nd : res;
+    for (node* cur = removed->p_; cur != sentinel_; cur = cur->p_) {
+      cur->size_--;
+    }
+    bool removed_red = nd->red_;
+    node* child;
+    node* child_parent;
+    if (nd->l_ == nullptr) {
+      child = nd->r_;
+      child_parent = nd->p_;
+      transplant(nd, child);
+    } else if (nd->r_ == nullptr) {
+      child = nd->l_;
+      child_parent = nd->p_;
+      transplant(nd, child);
     } else {
-      unlink(res);
-      res->p_ = nd->p_;
-      res->r_ = nd->r_;
-      res->l_ = nd->l_;
-      get_parent_ptr(nd) = res;
-      if (res->l_ != nullptr) {
-        res->l_->p_ = res;
-      }
-      if (res->r_ != nullptr) {
+      removed_red = res->red_;
+      child = res->r_;
+      if (res->p_ == nd) {
+        child_parent = res;
+      } else {
+        child_parent = res->p_;
+        transplant(res, child);
+        res->r_ = nd->r_;
         res->r_->p_ = res;
       }
-      if (sentinel_->l_ == nd) {
-        sentinel_->l_ = res;
-      }
-      if (sentinel_->r_ == nd) {
-        sentinel_->r_ = res;
-      }
+      transplant(nd, res);
+      res->l_ = nd->l_;
+      res->l_->p_ = res;
+      res->red_ = nd->red_;
+      res->size_ = nd->size_;
+    }
+    if (!removed_red) {
+      erase_fixup(child, child_parent);
     }
     return iterator(res);
   }
@@ -127,7 +303,8 @@ public:
     return iterator(sentinel_);
   }
 
-  iterator lower_bound(const T& key) const {
+  template <typename K>
+  iterator lower_bound(const K& key) const {
     node* prev = sentinel_;
     node* nd = get_root();
     while (nd != nullptr) {
@@ -146,7 +323,21 @@ public:
     return iterator(prev);
   }
 
-  iterator upper_bound(const T& value) const {
+  // checks hint and its successor before descending from the root,
+  // so a walk over ascending keys costs amortized O(1) per key near the previous one
+  template <typename K>
+  iterator lower_bound_hint(iterator hint, const K& key) const {
+    if (hint != end() && comp_(*hint, key)) {
+      ++hint;
+    }
+    if ((hint == end() || !comp_(*hint, key)) && (hint == begin() || comp_(*std::prev(hint), key))) {
+      return hint;
+    }
+    return lower_bound(key);
+  }
+
+  template <typename K>
+  iterator upper_bound(const K& value) const {
     iterator it = lower_bound(value);
     if (it != end() && !comp_(value, *it)) {
       it++;
@@ -154,7 +345,8 @@ public:
     return it;
   }
 
-  iterator find(const T& value) const {
+  template <typename K>
+  iterator find(const K& value) const {
     iterator it = lower_bound(value);
     if (it == end() || comp_(value, *it)) {
       return end();
@@ -162,7 +354,8 @@ public:
     return it;
   }
 
-  const Other& at_other(const T& key) const {
+  template <typename K>
+  const Other& at_other(const K& key) const {
     iterator it = find(key);
     if (it == end()) {
       throw std::out_of_range("key is not contained in the container");
@@ -171,6 +364,30 @@ public:
     }
   }
 
+  // end if k is not less than the size
+  iterator nth(std::size_t k) const noexcept {
+    if (k >= node::size_of(get_root())) {
+      return end();
+    }
+    return iterator(node::get_nth(get_root(), k));
+  }
+
+  // number of stored keys less than key
+  template <typename K>
+  std::size_t rank(const K& key) const {
+    std::size_t res = 0;
+    node* nd = get_root();
+    while (nd != nullptr) {
+      if (comp_(as_val(nd), key)) {
+        res += node::size_of(nd->l_) + 1;
+        nd = nd->r_;
+      } else {
+        nd = nd->l_;
+      }
+    }
+    return res;
+  }
+
   // returns true if successfully inserted bimap_node
   bool insert_node(node* ins, const T* value = nullptr) {
     if (value == nullptr) {
@@ -200,34 +417,72 @@ public:
     if (lowest) {
       sentinel_->r_ = ins;
     }
-    *nd = ins;
-    ins->p_ = prev;
+    attach(ins, prev, *nd);
     return true;
   }
 
-  void insert_before(node* ins, node* neighbour) {
+  void insert_before(node* ins, node* neighbour) noexcept {
     if (neighbour == sentinel_) {
       if (sentinel_->l_ == sentinel_) {
         sentinel_->l_ = ins;
         sentinel_->r_ = ins;
-        sentinel_->p_ = ins;
-        ins->p_ = sentinel_;
+        attach(ins, sentinel_, sentinel_->p_);
       } else {
-        sentinel_->l_->r_ = ins;
-        ins->p_ = sentinel_->l_;
+        node* prev_node = sentinel_->l_;
         sentinel_->l_ = ins;
+        attach(ins, prev_node, prev_node->r_);
       }
     } else if (neighbour->l_ == nullptr) {
-      neighbour->l_ = ins;
-      ins->p_ = neighbour;
       if (sentinel_->r_ == neighbour) {
         sentinel_->r_ = ins;
       }
+      attach(ins, neighbour, neighbour->l_);
     } else {
       node* prev_node = node::get_max(neighbour->l_);
-      prev_node->r_ = ins;
-      ins->p_ = prev_node;
+      attach(ins, prev_node, prev_node->r_);
+    }
+  }
+
+  // links nodes sorted by key without equivalent ones into an empty map; only the deepest
+  // level of the midpoint tree can be incomplete, so colouring it red keeps black heights equal
+  void build(value_node<Left, Right>* const* nodes, std::size_t count) noexcept {
+    if (count == 0) {
+      return;
+    }
+    node* root = build_subtree(nodes, count, 0, std::bit_width(count) - 1);
+    sentinel_->p_ = root;
+    root->p_ = sentinel_;
+    sentinel_->r_ = nodes[0];
+    sentinel_->l_ = nodes[count - 1];
+  }
+
+  // mirrors the links of other onto the copies of its nodes, the map must be empty
+  template <typename Clones>
+  void clone_links(const map& other, const Clones& clones) noexcept {
+    node* other_sentinel = other.sentinel_;
+    auto copy = [&](node* nd) -> node* {
+      if (nd == nullptr) {
+        return nullptr;
+      }
+      if (nd == other_sentinel) {
+        return sentinel_;
+      }
+      return clones.at(static_cast<value_node<Left, Right>*>(nd));
+    };
+    if (other.get_root() == nullptr) {
+      return;
+    }
+    for (node* nd = other.get_min(); nd != other_sentinel; nd = nd->get_next()) {
+      node* res = copy(nd);
+      res->l_ = copy(nd->l_);
+      res->r_ = copy(nd->r_);
+      res->p_ = copy(nd->p_);
+      res->red_ = nd->red_;
+      res->size_ = nd->size_;
     }
+    sentinel_->p_ = copy(other.get_root());
+    sentinel_->l_ = copy(other.get_max());
+    sentinel_->r_ = copy(other.get_min());
   }
 
   static void swap_sentinel(node* sl, node* sr) noexcept {
@@ -8,18 +8,98 @@ namespace bimap_components {
 struct tag_left;
 struct tag_right;
 
+// stores both indexes as red-black trees of intrusive nodes
+struct rb_tree_storage {
+  // subtree sizes make nth_* and rank_* logarithmic
+  static constexpr bool order_statistics = true;
+};
+
+template <typename Compare>
+concept transparent = requires { typename Compare::is_transparent; };
+
 template <typename Tag>
 class base_node {
 public:
   base_node* l_;
   base_node* r_;
   base_node* p_;
+  // number of nodes in the subtree, zero only for the sentinel
+  std::size_t size_;
+  bool red_;
 
 public:
   base_node() noexcept
       : l_(nullptr)
       , r_(nullptr)
-      , p_(nullptr) {}
+      , p_(nullptr)
+      , size_(0)
+      , red_(false) {}
+
+  static bool is_red(const base_node* nd) noexcept {
+    return nd != nullptr && nd->red_;
+  }
+
+  static std::size_t size_of(const base_node* nd) noexcept {
+    return nd == nullptr ? 0 : nd->size_;
+  }
+
+  void update_size() noexcept {
+    size_ = size_of(l_) + size_of(r_) + 1;
+  }
+
+  // the sentinel when called on it
+  base_node* get_root() noexcept {
+    if (size_ == 0) {
+      return p_;
+    }
+    base_node* nd = this;
+    while (nd->p_->size_ != 0) {
+      nd = nd->p_;
+    }
+    return nd;
+  }
+
+  // number of nodes before this one, the size of the tree for the sentinel
+  std::size_t get_rank() noexcept {
+    if (size_ == 0) {
+      return size_of(p_);
+    }
+    std::size_t res = size_of(l_);
+    for (base_node* nd = this; nd->p_->size_ != 0; nd = nd->p_) {
+      if (nd->p_->r_ == nd) {
+        res += size_of(nd->p_->l_) + 1;
+      }
+    }
+    return res;
+  }
+
+  // k-th node of the subtree, k must be less than its size
+  static base_node* get_nth(base_node* nd, std::size_t k) noexcept {
+    while (true) {
+      std::size_t left = size_of(nd->l_);
+      if (k < left) {
+        nd = nd->l_;
+      } else if (k == left) {
+        return nd;
+      } else {
+        k -= left + 1;
+        nd = nd->r_;
+      }
+    }
+  }
+
+  // node n positions away, the result must lie between the first node and the sentinel
+  base_node* advance(std::ptrdiff_t n) noexcept {
+    if (n == 0) {
+      return this;
+    }
+    base_node* root = get_root();
+    std::size_t target = get_rank() + n;
+    if (target == root->size_) {
+      return root->p_;
+    }
+    return get_nth(root, target);
+  }
 
   static base_node* get_max(base_node* nd) noexcept {
     while (nd->r_ != nullptr) {
@@ -0,0 +1,170 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+
+namespace bimap_components {
+
+// hands out fixed-size slots carved from contiguous chunks and keeps freed slots for reuse;
+// one pool serves every slot size requested through it, memory returns to the system on destruction
+class node_pool {
+  struct slot {
+    slot* next_;
+  };
+
+  struct chunk {
+    chunk* next_;
+  };
+
+  struct bucket {
+    std::size_t size_;
+    slot* free_;
+    bucket* next_;
+  };
+
+  static constexpr std::size_t ALIGN = alignof(std::max_align_t);
+  static constexpr std::size_t HEADER_SIZE = (sizeof(chunk) + ALIGN - 1) / ALIGN * ALIGN;
+
+public:
+  explicit node_pool(std::size_t chunk_slots) noexcept
+      : buckets_(nullptr)
+      , chunks_(nullptr)
+      , chunk_slots_(chunk_slots) {}
+
+  node_pool(const node_pool&) = delete;
+  node_pool& operator=(const node_pool&) = delete;
+
+  ~node_pool() {
+    while (chunks_ != nullptr) {
+      chunk* next = chunks_->next_;
+      operator delete(chunks_);
+      chunks_ = next;
+    }
+    while (buckets_ != nullptr) {
+      bucket* next = buckets_->next_;
+      delete buckets_;
+      buckets_ = next;
+    }
+  }
+
+  void* allocate(std::size_t size) {
+    bucket* bk = get_bucket(slot_size(size));
+    if (bk->free_ == nullptr) {
+      refill(bk);
+    }
+    slot* res = bk->free_;
+    bk->free_ = res->next_;
+    return res;
+  }
+
+  void deallocate(void* ptr, std::size_t size) noexcept {
+    bucket* bk = find_bucket(slot_size(size));
+    slot* sl = static_cast<slot*>(ptr);
+    sl->next_ = bk->free_;
+    bk->free_ = sl;
+  }
+
+private:
+  static std::size_t slot_size(std::size_t size) noexcept {
+    size = std::max(size, sizeof(slot));
+    return (size + ALIGN - 1) / ALIGN * ALIGN;
+  }
+
+  bucket* find_bucket(std::size_t size) const noexcept {
+    bucket* bk = buckets_;
+    while (bk != nullptr && bk->size_ != size) {
+      bk = bk->next_;
+    }
+    return bk;
+  }
+
+  bucket* get_bucket(std::size_t size) {
+    bucket* bk = find_bucket(size);
+    if (bk == nullptr) {
+      bk = new bucket{size, nullptr, buckets_};
+      buckets_ = bk;
+    }
+    return bk;
+  }
+
+  void refill(bucket* bk) {
+    auto* raw = static_cast<std::byte*>(operator new(HEADER_SIZE + chunk_slots_ * bk->size_));
+    chunk* ch = reinterpret_cast<chunk*>(raw);
+    ch->next_ = chunks_;
+    chunks_ = ch;
+    std::byte* first = raw + HEADER_SIZE;
+    for (std::size_t i = chunk_slots_; i > 0; --i) {
+      slot* sl = reinterpret_cast<slot*>(first + (i - 1) * bk->size_);
+      sl->next_ = bk->free_;
+      bk->free_ = sl;
+    }
+  }
+
+private:
+  bucket* buckets_;
+  chunk* chunks_;
+  std::size_t chunk_slots_;
+};
+
+} // namespace bimap_components
+
+// single-object allocations are served from a node_pool shared by all copies and rebinds;
+// the pool is not synchronized, so one pool must not be used from several threads at once
+template <typename T, std::size_t ChunkSlots = 256>
+class pool_allocator {
+  static_assert(ChunkSlots > 0, "chunk must contain at least one slot");
+  static_assert(alignof(T) <= alignof(std::max_align_t), "over-aligned types are not supported");
+
+  template <typename U, std::size_t S>
+  friend class pool_allocator;
+
+public:
+  using value_type = T;
+  using propagate_on_container_copy_assignment = std::true_type;
+  using propagate_on_container_move_assignment = std::true_type;
+  using propagate_on_container_swap = std::true_type;
+
+  template <typename U>
+  struct rebind {
+    using other = pool_allocator<U, ChunkSlots>;
+  };
+
+public:
+  pool_allocator()
+      : pool_(std::make_shared<bimap_components::node_pool>(ChunkSlots)) {}
+
+  template <typename U>
+  pool_allocator(const pool_allocator<U, ChunkSlots>& other) noexcept
+      : pool_(other.pool_) {}
+
+  T* allocate(std::size_t n) {
+    if (n != 1) {
+      return static_cast<T*>(operator new(n * sizeof(T)));
+    }
+    return static_cast<T*>(pool_->allocate(sizeof(T)));
+  }
+
+  void deallocate(T* ptr, std::size_t n) noexcept {
+    if (n != 1) {
+      operator delete(ptr);
+    } else {
+      pool_->deallocate(ptr, sizeof(T));
+    }
+  }
+
+  // a copied container gets its own pool instead of sharing the source one
+  pool_allocator select_on_container_copy_construction() const {
+    return pool_allocator();
+  }
+
+  template <typename U>
+  friend bool operator==(const pool_allocator& l, const pool_allocator<U, ChunkSlots>& r) noexcept {
+    return l.pool_ == r.pool_;
+  }
+
+private:
+  std::shared_ptr<bimap_components::node_pool> pool_;
+};
@@ -0,0 +1,626 @@
+#pragma once
+
+#include "nodes.h"
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+template <
+    typename Left,
+    typename Right,
+    typename HashLeft,
+    typename HashRight,
+    typename EqualLeft,
+    typename EqualRight>
+class unordered_bimap;
+
+namespace bimap_components {
+
+// robin hood table of positions in an external entry array: slots keep the low bits of the hash
+// to skip most key comparisons, erasure shifts the following run back instead of leaving tombstones
+class hash_index {
+  struct slot {
+    std::uint32_t dist_; // 1 at the home slot, 0 for an empty one
+    std::uint32_t tag_;
+    std::size_t entry_;
+  };
+
+  std::size_t home(std::size_t hash) const noexcept {
+    return static_cast<std::size_t>((static_cast<std::uint64_t>(hash) * 0x9E3779B97F4A7C15ull) >> shift_);
+  }
+
+  std::size_t next(std::size_t i) const noexcept {
+    return (i + 1) & (slots_.size() - 1);
+  }
+
+  // slot holding entry, which must be in the table
+  std::size_t locate(std::size_t hash, std::size_t entry) const noexcept {
+    std::size_t i = home(hash);
+    while (slots_[i].entry_ != entry || slots_[i].dist_ == 0) {
+      i = next(i);
+    }
+    return i;
+  }
+
+public:
+  static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+  hash_index() noexcept
+      : shift_(64) {}
+
+  // true if count entries would exceed the maximal load factor of 7/8
+  bool overloaded(std::size_t count) const noexcept {
+    return count * 8 > slots_.size() * 7;
+  }
+
+  // entry for which match returns true or npos
+  template <typename Match>
+  std::size_t find(std::size_t hash, Match match) const {
+    if (slots_.empty()) {
+      return npos;
+    }
+    std::uint32_t tag = static_cast<std::uint32_t>(hash);
+    std::size_t i = home(hash);
+    for (std::uint32_t dist = 1; slots_[i].dist_ >= dist; ++dist) {
+      if (slots_[i].tag_ == tag && match(slots_[i].entry_)) {
+        return slots_[i].entry_;
+      }
+      i = next(i);
+    }
+    return npos;
+  }
+
+  // there must be a free slot for the entry
+  void insert(std::size_t hash, std::size_t entry) noexcept {
+    slot cur{1, static_cast<std::uint32_t>(hash), entry};
+    std::size_t i = home(hash);
+    while (slots_[i].dist_ != 0) {
+      if (slots_[i].dist_ < cur.dist_) {
+        std::swap(slots_[i], cur);
+      }
+      i = next(i);
+      cur.dist_++;
+    }
+    slots_[i] = cur;
+  }
+
+  void erase(std::size_t hash, std::size_t entry) noexcept {
+    std::size_t i = locate(hash, entry);
+    for (std::size_t j = next(i); slots_[j].dist_ > 1; j = next(j)) {
+      slots_[i] = slots_[j];
+      slots_[i].dist_--;
+      i = j;
+    }
+    slots_[i].dist_ = 0;
+  }
+
+  // the entry at position from was moved to position to
+  void relink(std::size_t hash, std::size_t from, std::size_t to) noexcept {
+    slots_[locate(hash, from)].entry_ = to;
+  }
+
+  // rebuilds the table with capacity for at least count entries, hash_of returns the hash of an entry
+  template <typename HashOf>
+  void rehash(std::size_t count, std::size_t entries, HashOf hash_of) {
+    std::size_t capacity = std::bit_ceil(count + count / 7 + 1);
+    capacity = capacity < 8 ? 8 : capacity;
+    std::vector<slot> slots(capacity, slot{0, 0, 0});
+    slots_.swap(slots);
+    shift_ = 64 - std::countr_zero(capacity);
+    for (std::size_t i = 0; i < entries; ++i) {
+      insert(hash_of(i), i);
+    }
+  }
+
+  void clear() noexcept {
+    for (slot& s : slots_) {
+      s.dist_ = 0;
+    }
+  }
+
+private:
+  int shift_;
+  std::vector<slot> slots_;
+};
+
+template <typename Left, typename Right>
+struct hashed_entry {
+  template <typename L, typename R>
+  hashed_entry(L&& left, R&& right, std::size_t left_hash, std::size_t right_hash)
+      : left_(std::forward<L>(left))
+      , right_(std::forward<R>(right))
+      , left_hash_(left_hash)
+      , right_hash_(right_hash) {}
+
+  template <typename Tag>
+  const auto& key() const noexcept {
+    if constexpr (std::is_same_v<Tag, tag_left>) {
+      return left_;
+    } else {
+      return right_;
+    }
+  }
+
+  Left left_;
+  Right right_;
+  std::size_t left_hash_;
+  std::size_t right_hash_;
+};
+
+template <typename T, typename Other, typename Tag>
+class hashed_iterator {
+  using Left = std::conditional_t<std::is_same_v<Tag, tag_left>, T, Other>;
+  using Right = std::conditional_t<std::is_same_v<Tag, tag_left>, Other, T>;
+  using OtherTag = std::conditional_t<std::is_same_v<Tag, tag_left>, tag_right, tag_left>;
+  using OtherIterator = hashed_iterator<Other, T, OtherTag>;
+  using Entry = hashed_entry<Left, Right>;
+
+public:
+  using difference_type = std::ptrdiff_t;
+  using value_type = T;
+  using pointer = const T*;
+  using reference = const T&;
+  using iterator_category = std::forward_iterator_tag;
+
+private:
+  template <typename L, typename R, typename HL, typename HR, typename EL, typename ER>
+  friend class ::unordered_bimap;
+
+  template <typename Y, typename OtherY, typename Tg>
+  friend class hashed_iterator;
+
+  hashed_iterator(const Entry* cur) noexcept
+      : cur_(cur) {}
+
+public:
+  hashed_iterator() noexcept
+      : cur_(nullptr) {}
+
+  reference operator*() const noexcept {
+    return cur_->template key<Tag>();
+  }
+
+  pointer operator->() const noexcept {
+    return &cur_->template key<Tag>();
+  }
+
+  hashed_iterator& operator++() noexcept {
+    ++cur_;
+    return *this;
+  }
+
+  hashed_iterator operator++(int) noexcept {
+    hashed_iterator tmp = *this;
+    ++*this;
+    return tmp;
+  }
+
+  OtherIterator flip() const noexcept {
+    return {cur_};
+  }
+
+  friend bool operator==(const hashed_iterator& lhs, const hashed_iterator& rhs) noexcept {
+    return lhs.cur_ == rhs.cur_;
+  }
+
+  friend bool operator!=(const hashed_iterator& lhs, const hashed_iterator& rhs) noexcept {
+    return !(lhs == rhs);
+  }
+
+private:
+  const Entry* cur_;
+};
+
+} // namespace bimap_components
+
+// bimap without ordering: pairs lie in one dense array and each side has its own hash index
+// into it, so lookups in both directions take O(1) expected. Erasure moves the last pair
+// into the freed position, so iteration order is unspecified and any change invalidates iterators
+template <
+    typename Left,
+    typename Right,
+    typename HashLeft = std::hash<Left>,
+    typename HashRight = std::hash<Right>,
+    typename EqualLeft = std::equal_to<Left>,
+    typename EqualRight = std::equal_to<Right>>
+class unordered_bimap {
+  using Entry = bimap_components::hashed_entry<Left, Right>;
+  using Index = bimap_components::hash_index;
+
+  // erase_entry relinks both indexes before moving the last pair into the hole, which it cannot undo
+  static_assert(
+      std::is_nothrow_move_assignable_v<Left> && std::is_nothrow_move_assignable_v<Right>,
+      "unordered_bimap keys must be nothrow move assignable"
+  );
+
+public:
+  using left_iterator = bimap_components::hashed_iterator<Left, Right, bimap_components::tag_left>;
+
+  using right_iterator = bimap_components::hashed_iterator<Right, Left, bimap_components::tag_right>;
+
+private:
+  template <typename Tag>
+  using tag_type_v = std::conditional_t<std::is_same_v<Tag, bimap_components::tag_left>, Left, Right>;
+
+  template <typename Tag>
+  using tag_other_v = std::conditional_t<
+      std::is_same_v<Tag, bimap_components::tag_left>,
+      bimap_components::tag_right,
+      bimap_components::tag_left>;
+
+  template <typename Tag>
+  using base_iterator =
+      std::conditional_t<std::is_same_v<Tag, bimap_components::tag_left>, left_iterator, right_iterator>;
+
+  template <typename Tag>
+  static constexpr bool is_transparent_v = std::conditional_t<
+      std::is_same_v<Tag, bimap_components::tag_left>,
+      std::bool_constant<bimap_components::transparent<HashLeft> && bimap_components::transparent<EqualLeft>>,
+      std::bool_constant<bimap_components::transparent<HashRight> && bimap_components::transparent<EqualRight>>>::value;
+
+  template <typename Tag, typename K>
+  std::size_t hash(const K& key) const {
+    if constexpr (std::is_same_v<Tag, bimap_components::tag_left>) {
+      return hash_left_(key);
+    } else {
+      return hash_right_(key);
+    }
+  }
+
+  template <typename Tag, typename K>
+  bool equal(const K& key, const tag_type_v<Tag>& stored) const {
+    if constexpr (std::is_same_v<Tag, bimap_components::tag_left>) {
+      return equal_left_(key, stored);
+    } else {
+      return equal_right_(key, stored);
+    }
+  }
+
+  template <typename Tag>
+  Index& index() noexcept {
+    if constexpr (std::is_same_v<Tag, bimap_components::tag_left>) {
+      return left_index_;
+    } else {
+      return right_index_;
+    }
+  }
+
+  template <typename Tag>
+  const Index& index() const noexcept {
+    return const_cast<unordered_bimap&>(*this).index<Tag>();
+  }
+
+  template <typename Tag>
+  base_iterator<Tag> iterator_at(std::size_t entry) const noexcept {
+    return {entries_.data() + entry};
+  }
+
+  // position of the entry with the given key and its hash or npos
+  template <typename Tag, typename K>
+  std::size_t find_entry(const K& key, std::size_t key_hash) const {
+    return index<Tag>().find(key_hash, [this, &key](std::size_t entry) {
+      return equal<Tag>(key, entries_[entry].template key<Tag>());
+    });
+  }
+
+  template <typename Tag, typename K>
+  std::size_t find_entry(const K& key) const {
+    return find_entry<Tag>(key, hash<Tag>(key));
+  }
+
+  template <typename Tag, typename K>
+  base_iterator<Tag> find(const K& key) const {
+    std::size_t entry = find_entry<Tag>(key);
+    return iterator_at<Tag>(entry == Index::npos ? entries_.size() : entry);
+  }
+
+  template <typename Tag, typename K>
+  const tag_type_v<tag_other_v<Tag>>& at_other(const K& key) const {
+    std::size_t entry = find_entry<Tag>(key);
+    if (entry == Index::npos) {
+      throw std::out_of_range("key is not contained in the container");
+    }
+    return entries_[entry].template key<tag_other_v<Tag>>();
+  }
+
+  void rehash_indexes(std::size_t count) {
+    left_index_.rehash(count, entries_.size(), [this](std::size_t i) { return entries_[i].left_hash_; });
+    right_index_.rehash(count, entries_.size(), [this](std::size_t i) { return entries_[i].right_hash_; });
+  }
+
+  template <typename L, typename R>
+  left_iterator base_insert(L&& left, R&& right) {
+    std::size_t left_hash = hash<bimap_components::tag_left>(left);
+    std::size_t right_hash = hash<bimap_components::tag_right>(right);
+    if (find_entry<bimap_components::tag_left>(left, left_hash) != Index::npos ||
+        find_entry<bimap_components::tag_right>(right, right_hash) != Index::npos) {
+      return end_left();
+    }
+    if (left_index_.overloaded(size() + 1)) {
+      rehash_indexes(2 * size() + 1);
+    }
+    entries_.emplace_back(std::forward<L>(left), std::forward<R>(right), left_hash, right_hash);
+    left_index_.insert(left_hash, size() - 1);
+    right_index_.insert(right_hash, size() - 1);
+    return iterator_at<bimap_components::tag_left>(size() - 1);
+  }
+
+  // moves the last entry into the erased position
+  void erase_entry(std::size_t entry) noexcept {
+    std::size_t last = size() - 1;
+    left_index_.erase(entries_[entry].left_hash_, entry);
+    right_index_.erase(entries_[entry].right_hash_, entry);
+    if (entry != last) {
+      left_index_.relink(entries_[last].left_hash_, last, entry);
+      right_index_.relink(entries_[last].right_hash_, last, entry);
+      entries_[entry] = std::move(entries_[last]);
+    }
+    entries_.pop_back();
+  }
+
+  template <typename Tag, typename K>
+  bool erase_value(const K& key) {
+    std::size_t entry = find_entry<Tag>(key);
+    if (entry == Index::npos) {
+      return false;
+    }
+    erase_entry(entry);
+    return true;
+  }
+
+  template <typename Tag>
+  std::size_t position(base_iterator<Tag> it) const noexcept {
+    return static_cast<std::size_t>(it.cur_ - entries_.data());
+  }
+
+  // erased positions are refilled from the end, so the returned iterator
+  // is followed by every pair that was not reached yet
+  template <typename Tag>
+  base_iterator<Tag> erase_range(base_iterator<Tag> first, base_iterator<Tag> last) noexcept {
+    std::size_t from = position<Tag>(first);
+    for (std::size_t i = position<Tag>(last); i > from; --i) {
+      erase_entry(i - 1);
+    }
+    return iterator_at<Tag>(from);
+  }
+
+  template <typename Tag>
+  const tag_type_v<tag_other_v<Tag>>& at_other_or_default(const tag_type_v<Tag>& key) {
+    std::size_t entry = find_entry<Tag>(key);
+    if (entry != Index::npos) {
+      return entries_[entry].template key<tag_other_v<Tag>>();
+    }
+    // both keys are built before the pair holding the default is erased, so a throwing copy changes nothing
+    auto key_copy = tag_type_v<Tag>(key);
+    auto default_value = tag_type_v<tag_other_v<Tag>>();
+    std::size_t other_entry = find_entry<tag_other_v<Tag>>(default_value);
+    if (other_entry != Index::npos) {
+      erase_entry(other_entry);
+    }
+    if constexpr (std::is_same_v<Tag, bimap_components::tag_left>) {
+      return *insert(std::move(key_copy), std::move(default_value)).flip();
+    } else {
+      return *insert(std::move(default_value), std::move(key_copy));
+    }
+  }
+
+public:
+  unordered_bimap(
+      HashLeft hash_left = HashLeft(),
+      HashRight hash_right = HashRight(),
+      EqualLeft equal_left = EqualLeft(),
+      EqualRight equal_right = EqualRight()
+  )
+      : hash_left_(std::move(hash_left))
+      , hash_right_(std::move(hash_right))
+      , equal_left_(std::move(equal_left))
+      , equal_right_(std::move(equal_right)) {}
+
+  template <std::input_iterator It>
+  unordered_bimap(
+      It first,
+      It last,
+      HashLeft hash_left = HashLeft(),
+      HashRight hash_right = HashRight(),
+      EqualLeft equal_left = EqualLeft(),
+      EqualRight equal_right = EqualRight()
+  )
+      : unordered_bimap(std::move(hash_left), std::move(hash_right), std::move(equal_left), std::move(equal_right)) {
+    if constexpr (std::forward_iterator<It>) {
+      reserve(static_cast<std::size_t>(std::distance(first, last)));
+    }
+    for (; first != last; ++first) {
+      auto&& pair = *first;
+      base_insert(std::get<0>(std::forward<decltype(pair)>(pair)), std::get<1>(std::forward<decltype(pair)>(pair)));
+    }
+  }
+
+  friend void swap(unordered_bimap& l, unordered_bimap& r) noexcept {
+    using std::swap;
+    swap(l.entries_, r.entries_);
+    swap(l.left_index_, r.left_index_);
+    swap(l.right_index_, r.right_index_);
+    swap(l.hash_left_, r.hash_left_);
+    swap(l.hash_right_, r.hash_right_);
+    swap(l.equal_left_, r.equal_left_);
+    swap(l.equal_right_, r.equal_right_);
+  }
+
+  void reserve(std::size_t count) {
+    entries_.reserve(count);
+    if (left_index_.overloaded(count)) {
+      rehash_indexes(count);
+    }
+  }
+
+  void clear() noexcept {
+    entries_.clear();
+    left_index_.clear();
+    right_index_.clear();
+  }
+
+  left_iterator insert(const Left& left, const Right& right) {
+    return base_insert(left, right);
+  }
+
+  left_iterator insert(const Left& left, Right&& right) {
+    return base_insert(left, std::move(right));
+  }
+
+  left_iterator insert(Left&& left, const Right& right) {
+    return base_insert(std::move(left), right);
+  }
+
+  left_iterator insert(Left&& left, Right&& right) {
+    return base_insert(std::move(left), std::move(right));
+  }
+
+  // the returned iterator points to the pair moved into the erased position
+  left_iterator erase_left(left_iterator it) noexcept {
+    erase_entry(position<bimap_components::tag_left>(it));
+    return it;
+  }
+
+  right_iterator erase_right(right_iterator it) noexcept {
+    erase_entry(position<bimap_components::tag_right>(it));
+    return it;
+  }
+
+  bool erase_left(const Left& left) {
+    return erase_value<bimap_components::tag_left>(left);
+  }
+
+  template <typename K>
+    requires is_transparent_v<bimap_components::tag_left> && (!std::is_convertible_v<const K&, left_iterator>)
+  bool erase_left(const K& left) {
+    return erase_value<bimap_components::tag_left>(left);
+  }
+
+  bool erase_right(const Right& right) {
+    return erase_value<bimap_components::tag_right>(right);
+  }
+
+  template <typename K>
+    requires is_transparent_v<bimap_components::tag_right> && (!std::is_convertible_v<const K&, right_iterator>)
+  bool erase_right(const K& right) {
+    return erase_value<bimap_components::tag_right>(right);
+  }
+
+  left_iterator erase_left(left_iterator first, left_iterator last) noexcept {
+    return erase_range<bimap_components::tag_left>(first, last);
+  }
+
+  right_iterator erase_right(right_iterator first, right_iterator last) noexcept {
+    return erase_range<bimap_components::tag_right>(first, last);
+  }
+
+  left_iterator find_left(const Left& left) const {
+    return find<bimap_components::tag_left>(left);
+  }
+
+  template <typename K>
+    requires is_transparent_v<bimap_components::tag_left>
+  left_iterator find_left(const K& left) const {
+    return find<bimap_components::tag_left>(left);
+  }
+
+  right_iterator find_right(const Right& right) const {
+    return find<bimap_components::tag_right>(right);
+  }
+
+  template <typename K>
+    requires is_transparent_v<bimap_components::tag_right>
+  right_iterator find_right(const K& right) const {
+    return find<bimap_components::tag_right>(right);
+  }
+
+  const Right& at_left(const Left& key) const {
+    return at_other<bimap_components::tag_left>(key);
+  }
+
+  template <typename K>
+    requires is_transparent_v<bimap_components::tag_left>
+  const Right& at_left(const K& key) const {
+    return at_other<bimap_components::tag_left>(key);
+  }
+
+  const Left& at_right(const Right& key) const {
+    return at_other<bimap_components::tag_right>(key);
+  }
+
+  template <typename K>
+    requires is_transparent_v<bimap_components::tag_right>
+  const Left& at_right(const K& key) const {
+    return at_other<bimap_components::tag_right>(key);
+  }
+
+  const Right& at_left_or_default(const Left& key)
+    requires std::is_default_constructible_v<Right>
+  {
+    return at_other_or_default<bimap_components::tag_left>(key);
+  }
+
+  const Left& at_right_or_default(const Right& key)
+    requires std::is_default_constructible_v<Left>
+  {
+    return at_other_or_default<bimap_components::tag_right>(key);
+  }
+
+  left_iterator begin_left() const noexcept {
+    return iterator_at<bimap_components::tag_left>(0);
+  }
+
+  left_iterator end_left() const noexcept {
+    return iterator_at<bimap_components::tag_left>(size());
+  }
+
+  right_iterator begin_right() const noexcept {
+    return iterator_at<bimap_components::tag_right>(0);
+  }
+
+  right_iterator end_right() const noexcept {
+    return iterator_at<bimap_components::tag_right>(size());
+  }
+
+  bool empty() const noexcept {
+    return size() == 0;
+  }
+
+  std::size_t size() const noexcept {
+    return entries_.size();
+  }
+
+  friend bool operator==(const unordered_bimap& l, const unordered_bimap& r) {
+    if (l.size() != r.size()) {
+      return false;
+    }
+    for (const Entry& e : l.entries_) {
+      std::size_t entry = r.template find_entry<bimap_components::tag_left>(e.left_);
+      if (entry == Index::npos || !l.equal_right_(e.right_, r.entries_[entry].right_)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  friend bool operator!=(const unordered_bimap& l, const unordered_bimap& r) {
+    return !(l == r);
+  }
+
+private:
+  std::vector<Entry> entries_;
+  Index left_index_;
+  Index right_index_;
+  [[no_unique_address]] HashLeft hash_left_;
+  [[no_unique_address]] HashRight hash_right_;
+  [[no_unique_address]] EqualLeft equal_left_;
+  [[no_unique_address]] EqualRight equal_right_;
+};
@@ -0,0 +1,389 @@
+#pragma once
+
+#include "matrix-gemm.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <type_traits>
+#include <utility>
+
+template <class T>
+struct matrix;
+
+// lazy matrix arithmetic: operators build expression nodes and nothing is computed until the
+// expression is assigned to a matrix, so chained element-wise operations run as a single pass.
+// nodes keep references to their matrix operands, so they must not outlive the full expression
+namespace matrix_expr {
+
+template <typename M>
+inline constexpr bool is_matrix_v = false;
+
+template <typename T>
+inline constexpr bool is_matrix_v<matrix<T>> = true;
+
+template <typename E>
+inline constexpr bool is_node_v = false;
+
+template <typename E>
+inline constexpr bool is_product_v = false;
+
+template <typename E>
+concept node = is_node_v<std::remove_cvref_t<E>>;
+
+template <typename E, typename M>
+concept operand_of = std::is_same_v<std::remove_cvref_t<E>, M> ||
+                     (node<E> && std::is_same_v<typename std::remove_cvref_t<E>::matrix_type, M>);
+
+template <typename E>
+struct matrix_of {};
+
+template <typename E>
+  requires requires { typename E::matrix_type; }
+struct matrix_of<E> {
+  using type = typename E::matrix_type;
+};
+
+template <typename T>
+struct matrix_of<matrix<T>> {
+  using type = matrix<T>;
+};
+
+template <typename E>
+using matrix_of_t = typename matrix_of<std::remove_cvref_t<E>>::type;
+
+// every node is parameterized by the matrix type, so argument-dependent lookup on any
+// expression also finds the hidden friends of matrix
+template <typename M>
+struct ref {
+  using matrix_type = M;
+  using value_type = typename M::value_type;
+
+  explicit ref(const M& m) : _m(&m) {}
+
+  size_t rows() const {
+    return _m->rows();
+  }
+
+  size_t cols() const {
+    return _m->cols();
+  }
+
+  const value_type& operator[](const size_t i) const {
+    return _m->data()[i];
+  }
+
+  void prepare() const {}
+
+  bool aliases(const M&) const {
+    return false;
+  }
+
+private:
+  const M* _m;
+};
+
+template <typename M>
+inline constexpr bool is_node_v<ref<M>> = true;
+
+// a temporary matrix operand, moved into the expression so it lives as long as the expression does
+template <typename M>
+struct owned {
+  using matrix_type = M;
+  using value_type = typename M::value_type;
+
+  explicit owned(M&& m) : _m(std::move(m)) {}
+
+  size_t rows() const {
+    return _m.rows();
+  }
+
+  size_t cols() const {
+    return _m.cols();
+  }
+
+  const value_type& operator[](const size_t i) const {
+    return _m.data()[i];
+  }
+
+  void prepare() const {}
+
+  bool aliases(const M&) const {
+    return false;
+  }
+
+private:
+  M _m;
+};
+
+template <typename M>
+inline constexpr bool is_node_v<owned<M>> = true;
+
+template <typename M, typename L, typename R, typename Op>
+struct elementwise {
+  using matrix_type = M;
+  using value_type = typename M::value_type;
+
+  elementwise(L left, R right) : _left(std::move(left)), _right(std::move(right)) {}
+
+  size_t rows() const {
+    return _left.rows();
+  }
+
+  size_t cols() const {
+    return _left.cols();
+  }
+
+  value_type operator[](const size_t i) const {
+    return Op()(_left[i], _right[i]);
+  }
+
+  void prepare() const {
+    _left.prepare();
+    _right.prepare();
+  }
+
+  bool aliases(const M& m) const {
+    return _left.aliases(m) || _right.aliases(m);
+  }
+
+  const L& left() const {
+    return _left;
+  }
+
+  const R& right() const {
+    return _right;
+  }
+
+private:
+  L _left;
+  R _right;
+};
+
+template <typename M, typename L, typename R, typename Op>
+inline constexpr bool is_node_v<elementwise<M, L, R, Op>> = true;
+
+template <typename M, typename E>
+struct scaled {
+  using matrix_type = M;
+  using value_type = typename M::value_type;
+
+  scaled(E expr, const value_type& factor) : _expr(std::move(expr)), _factor(factor) {}
+
+  size_t rows() const {
+    return _expr.rows();
+  }
+
+  size_t cols() const {
+    return _expr.cols();
+  }
+
+  value_type operator[](const size_t i) const {
+    return _expr[i] * _factor;
+  }
+
+  void prepare() const {
+    _expr.prepare();
+  }
+
+  bool aliases(const M& m) const {
+    return _expr.aliases(m);
+  }
+
+private:
+  E _expr;
+  value_type _factor;
+};
+
+template <typename M, typename E>
+inline constexpr bool is_node_v<scaled<M, E>> = true;
+
+// an operand of a product: either a matrix the caller owns, a temporary moved in
+// or an evaluated subexpression
+template <typename M>
+struct dense {
+  dense(const M& m) : _ptr(&m) {}
+
+  dense(M&& m) : _owned(std::move(m)), _ptr(nullptr) {}
+
+  template <node E>
+  dense(const E& expr) : _owned(expr), _ptr(nullptr) {}
+
+  const M& get() const {
+    return _ptr != nullptr ? *_ptr : _owned;
+  }
+
+private:
+  M _owned;
+  const M* _ptr;
+};
+
+// added straight into the destination when it stands alone or as a term of a top-level sum,
+// otherwise evaluated into its own matrix by prepare before the element-wise pass
+template <typename M>
+struct product {
+  using matrix_type = M;
+  using value_type = typename M::value_type;
+
+  product(dense<M> left, dense<M> right) : _left(std::move(left)), _right(std::move(right)) {}
+
+  size_t rows() const {
+    return _left.get().rows();
+  }
+
+  size_t cols() const {
+    return _right.get().cols();
+  }
+
+  const value_type& operator[](const size_t i) const {
+    return _result.data()[i];
+  }
+
+  void prepare() const {
+    if (_result.empty() && rows() * cols() != 0) {
+      M res(rows(), cols());
+      add_to(res.data());
+      swap(_result, res);
+    }
+  }
+
+  bool aliases(const M& m) const {
+    return &_left.get() == &m || &_right.get() == &m;
+  }
+
+  void add_to(value_type* dst) const {
+    const M& left = _left.get();
+    const M& right = _right.get();
+    if (rows() * cols() != 0) {
+      matrix_gemm::multiply(left.data(), right.data(), dst, left.rows(), left.cols(), right.cols());
+    }
+  }
+
+private:
+  dense<M> _left;
+  dense<M> _right;
+  mutable M _result;
+};
+
+template <typename M>
+inline constexpr bool is_node_v<product<M>> = true;
+
+template <typename M>
+inline constexpr bool is_product_v<product<M>> = true;
+
+// lvalue matrices are referenced, temporaries are moved into the node
+template <typename E>
+auto wrap(E&& e) {
+  using D = std::remove_cvref_t<E>;
+  if constexpr (is_matrix_v<D> && std::is_lvalue_reference_v<E>) {
+    return ref<D>(e);
+  } else if constexpr (is_matrix_v<D>) {
+    return owned<D>(std::move(e));
+  } else {
+    return D(std::forward<E>(e));
+  }
+}
+
+template <typename Op, typename L, typename R>
+auto make_elementwise(L&& left, R&& right) {
+  using M = matrix_of_t<L>;
+  auto l = wrap(std::forward<L>(left));
+  auto r = wrap(std::forward<R>(right));
+  return elementwise<M, decltype(l), decltype(r), Op>(std::move(l), std::move(r));
+}
+
+template <typename E>
+auto make_scaled(E&& expr, const typename matrix_of_t<E>::value_type& factor) {
+  using M = matrix_of_t<E>;
+  auto e = wrap(std::forward<E>(expr));
+  return scaled<M, decltype(e)>(std::move(e), factor);
+}
+
+template <typename L, typename R>
+auto make_product(L&& left, R&& right) {
+  using M = matrix_of_t<L>;
+  return product<M>(dense<M>(std::forward<L>(left)), dense<M>(std::forward<R>(right)));
+}
+
+// a sum whose product term can be accumulated into the destination after the other term is written.
+// only for arithmetic elements, where starting the dot products from the other term is a valid reordering
+template <typename E>
+inline constexpr bool fused_sum_v = false;
+
+template <typename M, typename L, typename R>
+inline constexpr bool fused_sum_v<elementwise<M, L, R, std::plus<>>> =
+    std::is_arithmetic_v<typename M::value_type> && (is_product_v<L> || is_product_v<R>);
+
+// writes expr into the n elements of dst; a product operand must not share storage with dst
+template <typename E>
+void assign(const E& expr, typename E::value_type* dst, const size_t n) {
+  if constexpr (is_product_v<E>) {
+    std::fill(dst, dst + n, typename E::value_type());
+    expr.add_to(dst);
+  } else if constexpr (fused_sum_v<E>) {
+    if constexpr (is_product_v<std::remove_cvref_t<decltype(expr.left())>>) {
+      assign(expr.right(), dst, n);
+      expr.left().add_to(dst);
+    } else {
+      assign(expr.left(), dst, n);
+      expr.right().add_to(dst);
+    }
+  } else {
+    expr.prepare();
+    for (size_t i = 0; i < n; ++i) {
+      dst[i] = expr[i];
+    }
+  }
+}
+
+// adds expr to the n elements of dst under the same aliasing rule as assign
+template <typename E>
+void add_assign(const E& expr, typename E::value_type* dst, const size_t n) {
+  if constexpr (is_product_v<E> && std::is_arithmetic_v<typename E::value_type>) {
+    expr.add_to(dst);
+  } else {
+    expr.prepare();
+    for (size_t i = 0; i < n; ++i) {
+      dst[i] = dst[i] + expr[i];
+    }
+  }
+}
+
+template <typename E>
+void subtract_assign(const E& expr, typename E::value_type* dst, const size_t n) {
+  expr.prepare();
+  for (size_t i = 0; i < n; ++i) {
+    dst[i] = dst[i] - expr[i];
+  }
+}
+
+// operators for mixed matrix and expression operands; matrix with matrix is handled by the hidden friends
+template <typename L, typename R>
+  requires ((node<L> || node<R>) && operand_of<L, matrix_of_t<L>> && operand_of<R, matrix_of_t<L>>)
+auto operator+(L&& left, R&& right) {
+  return make_elementwise<std::plus<>>(std::forward<L>(left), std::forward<R>(right));
+}
+
+template <typename L, typename R>
+  requires ((node<L> || node<R>) && operand_of<L, matrix_of_t<L>> && operand_of<R, matrix_of_t<L>>)
+auto operator-(L&& left, R&& right) {
+  return make_elementwise<std::minus<>>(std::forward<L>(left), std::forward<R>(right));
+}
+
+template <typename L, typename R>
+  requires ((node<L> || node<R>) && operand_of<L, matrix_of_t<L>> && operand_of<R, matrix_of_t<L>>)
+auto operator*(L&& left, R&& right) {
+  return make_product(std::forward<L>(left), std::forward<R>(right));
+}
+
+template <node E>
+auto operator*(E&& expr, const typename matrix_of_t<E>::value_type& factor) {
+  return make_scaled(std::forward<E>(expr), factor);
+}
+
+template <node E>
+auto operator*(const typename matrix_of_t<E>::value_type& factor, E&& expr) {
+  return make_scaled(std::forward<E>(expr), factor);
+}
+
+} // namespace matrix_expr
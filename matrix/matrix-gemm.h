@@ -0,0 +1,205 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+
+#if defined(__GNUC__) && defined(__SSE2__)
+#define MATRIX_GEMM_X86 1
+#else
+#define MATRIX_GEMM_X86 0
+#endif
+
+namespace matrix_gemm {
+
+// element types the packed kernel handles; everything else takes the generic loop
+template <typename T>
+inline constexpr bool SUPPORTED = std::is_arithmetic_v<T> && !std::is_same_v<T, bool> &&
+                                  (sizeof(T) == 4 || sizeof(T) == 8);
+
+// c(i, j) = c(i, j) + a(i, p) * b(p, j) in increasing p, rows of b are walked contiguously
+template <typename T>
+void generic(const T* a, const T* b, T* c, std::size_t m, std::size_t k, std::size_t n) {
+  for (std::size_t i = 0; i < m; ++i) {
+    T* c_row = c + i * n;
+    for (std::size_t p = 0; p < k; ++p) {
+      const T& a_ip = a[i * k + p];
+      const T* b_row = b + p * n;
+      for (std::size_t j = 0; j < n; ++j) {
+        c_row[j] = c_row[j] + a_ip * b_row[j];
+      }
+    }
+  }
+}
+
+#if MATRIX_GEMM_X86
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpsabi"
+
+// packed GEMM over W-byte registers, always inlined into the target-specific wrappers below
+// so that the same body compiles to SSE2 or AVX2 instructions.
+// c is split into NC-column panels, k into KC-deep slices and the rows into MC-row blocks;
+// the slice of b is packed into NR-wide strips (kept in L2/L3), the block of a into MR-high strips
+// (kept in L1/L2) and an MR x NR tile of c lives in registers for the whole slice
+template <typename T, std::size_t W>
+struct kernel {
+  using vec [[gnu::vector_size(W)]] = T;
+  static constexpr std::size_t LANES = W / sizeof(T);
+
+  static constexpr std::size_t MR = 6;
+  static constexpr std::size_t NR = 2 * LANES;
+  static constexpr std::size_t KC = 256;
+  static constexpr std::size_t MC = 16 * MR;
+  static constexpr std::size_t NC = 256 * NR;
+
+  __attribute__((always_inline)) static vec load(const T* p) noexcept {
+    vec v;
+    std::memcpy(&v, p, W);
+    return v;
+  }
+
+  __attribute__((always_inline)) static void store(T* p, const vec& v) noexcept {
+    std::memcpy(p, &v, W);
+  }
+
+  // rows [0, mc) of a kc-deep slice of a, MR rows at a time, zero padded to whole strips
+  __attribute__((always_inline)) static void pack_a(const T* a, std::size_t lda, std::size_t mc, std::size_t kc,
+                                                    T* dst) noexcept {
+    for (std::size_t ir = 0; ir < mc; ir += MR) {
+      std::size_t mr = std::min(MR, mc - ir);
+      for (std::size_t p = 0; p < kc; ++p) {
+        for (std::size_t r = 0; r < mr; ++r) {
+          dst[r] = a[(ir + r) * lda + p];
+        }
+        for (std::size_t r = mr; r < MR; ++r) {
+          dst[r] = T();
+        }
+        dst += MR;
+      }
+    }
+  }
+
+  // columns [0, nc) of a kc-deep slice of b, NR columns at a time, zero padded to whole strips
+  __attribute__((always_inline)) static void pack_b(const T* b, std::size_t ldb, std::size_t kc, std::size_t nc,
+                                                    T* dst) noexcept {
+    for (std::size_t jr = 0; jr < nc; jr += NR) {
+      std::size_t nr = std::min(NR, nc - jr);
+      for (std::size_t p = 0; p < kc; ++p) {
+        const T* src = b + p * ldb + jr;
+        if (nr == NR) {
+          std::memcpy(dst, src, NR * sizeof(T));
+        } else {
+          std::copy_n(src, nr, dst);
+          std::fill(dst + nr, dst + NR, T());
+        }
+        dst += NR;
+      }
+    }
+  }
+
+  // adds the product of an MR-high strip of a and an NR-wide strip of b to the mr x nr corner of c
+  __attribute__((always_inline)) static void micro(std::size_t kc, const T* ap, const T* bp, T* c, std::size_t ldc,
+                                                   std::size_t mr, std::size_t nr) noexcept {
+    vec acc[MR][2] = {};
+    for (std::size_t p = 0; p < kc; ++p) {
+      vec b0 = load(bp);
+      vec b1 = load(bp + LANES);
+#pragma GCC unroll 8
+      for (std::size_t r = 0; r < MR; ++r) {
+        acc[r][0] += ap[r] * b0;
+        acc[r][1] += ap[r] * b1;
+      }
+      ap += MR;
+      bp += NR;
+    }
+    if (mr == MR && nr == NR) {
+#pragma GCC unroll 8
+      for (std::size_t r = 0; r < MR; ++r) {
+        T* row = c + r * ldc;
+        store(row, load(row) + acc[r][0]);
+        store(row + LANES, load(row + LANES) + acc[r][1]);
+      }
+    } else {
+      T tile[MR][NR];
+      std::memcpy(tile, acc, sizeof(tile));
+      for (std::size_t r = 0; r < mr; ++r) {
+        for (std::size_t j = 0; j < nr; ++j) {
+          c[r * ldc + j] += tile[r][j];
+        }
+      }
+    }
+  }
+
+  __attribute__((always_inline)) static void multiply(const T* a, const T* b, T* c, std::size_t m, std::size_t k,
+                                                      std::size_t n) {
+    std::size_t nc_max = std::min(NC, (n + NR - 1) / NR * NR);
+    std::size_t mc_max = std::min(MC, (m + MR - 1) / MR * MR);
+    std::size_t kc_max = std::min(KC, k);
+    std::unique_ptr<T[]> b_pack(new T[kc_max * nc_max]);
+    std::unique_ptr<T[]> a_pack(new T[mc_max * kc_max]);
+
+    for (std::size_t jc = 0; jc < n; jc += NC) {
+      std::size_t nc = std::min(NC, n - jc);
+      for (std::size_t pc = 0; pc < k; pc += KC) {
+        std::size_t kc = std::min(KC, k - pc);
+        pack_b(b + pc * n + jc, n, kc, nc, b_pack.get());
+        for (std::size_t ic = 0; ic < m; ic += MC) {
+          std::size_t mc = std::min(MC, m - ic);
+          pack_a(a + ic * k + pc, k, mc, kc, a_pack.get());
+          for (std::size_t jr = 0; jr < nc; jr += NR) {
+            const T* bp = b_pack.get() + jr * kc;
+            for (std::size_t ir = 0; ir < mc; ir += MR) {
+              micro(kc, a_pack.get() + ir * kc, bp, c + (ic + ir) * n + jc + jr, n, std::min(MR, mc - ir),
+                    std::min(NR, nc - jr));
+            }
+          }
+        }
+      }
+    }
+  }
+};
+
+template <typename T>
+__attribute__((target("avx2,fma"))) void multiply_avx2(const T* a, const T* b, T* c, std::size_t m, std::size_t k,
+                                                       std::size_t n) {
+  kernel<T, 32>::multiply(a, b, c, m, k, n);
+}
+
+#pragma GCC diagnostic pop
+
+inline bool has_avx2() noexcept {
+  static const bool result = [] {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") != 0 && __builtin_cpu_supports("fma") != 0;
+  }();
+  return result;
+}
+
+#endif
+
+// below this many multiply-adds packing costs more than it saves
+inline constexpr std::size_t MIN_FLOPS = 16 * 16 * 16;
+
+// adds a * b to c, where a is m x k, b is k x n and c is m x n, all dense and row-major.
+// floating point sums may be reassociated by the packed kernel
+template <typename T>
+void multiply(const T* a, const T* b, T* c, std::size_t m, std::size_t k, std::size_t n) {
+#if MATRIX_GEMM_X86
+  if constexpr (SUPPORTED<T>) {
+    if (m * k * n >= MIN_FLOPS) {
+      if (has_avx2()) {
+        multiply_avx2(a, b, c, m, k, n);
+      } else {
+        kernel<T, 16>::multiply(a, b, c, m, k, n);
+      }
+      return;
+    }
+  }
+#endif
+  generic(a, b, c, m, k, n);
+}
+
+} // namespace matrix_gemm
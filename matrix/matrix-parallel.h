@@ -0,0 +1,69 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <exception>
+#include <thread>
+#include <vector>
+
+namespace matrix_parallel {
+
+// requests that an operation be split across threads; 0 threads means one per hardware thread
+struct parallel_policy {
+  std::size_t threads = 0;
+
+  std::size_t resolve() const noexcept {
+    if (threads != 0) {
+      return threads;
+    }
+    return std::max<std::size_t>(1, std::thread::hardware_concurrency());
+  }
+};
+
+inline constexpr parallel_policy par{};
+
+// calls f(first, last) over consecutive chunks of [0, n), each at least min_chunk long,
+// one chunk on the calling thread and the rest on their own threads.
+// the first exception thrown by any chunk is rethrown after all of them finish
+template <typename F>
+void for_each_chunk(const parallel_policy& policy, std::size_t n, std::size_t min_chunk, const F& f) {
+  std::size_t chunks = std::min(policy.resolve(), std::max<std::size_t>(1, n / std::max<std::size_t>(1, min_chunk)));
+  if (chunks <= 1) {
+    f(std::size_t(0), n);
+    return;
+  }
+  std::size_t step = (n + chunks - 1) / chunks;
+  chunks = (n + step - 1) / step;
+
+  std::vector<std::exception_ptr> errors(chunks);
+  std::vector<std::thread> workers;
+  workers.reserve(chunks - 1);
+  auto run = [&](std::size_t chunk) {
+    try {
+      f(chunk * step, std::min(n, (chunk + 1) * step));
+    } catch (...) {
+      errors[chunk] = std::current_exception();
+    }
+  };
+  try {
+    for (std::size_t chunk = 1; chunk < chunks; ++chunk) {
+      workers.emplace_back(run, chunk);
+    }
+  } catch (...) {
+    for (std::thread& worker : workers) {
+      worker.join();
+    }
+    throw;
+  }
+  run(0);
+  for (std::thread& worker : workers) {
+    worker.join();
+  }
+  for (std::exception_ptr& error : errors) {
+    if (error) {
+      std::rethrow_exception(error);
+    }
+  }
+}
+
+} // namespace matrix_parallel
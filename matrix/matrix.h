@@ -1,8 +1,14 @@
 #pragma once
+#include "matrix-expr.h"
+#include "matrix-gemm.h"
+#include "matrix-parallel.h"
+
 #include <algorithm>
 #include <cstddef>
+#include <functional>
 #include <iterator>
-#include <numeric>
+#include <type_traits>
+#include <utility>
 
 template <class T>
 struct matrix {
@@ -140,6 +146,11 @@ public:
   using const_col_iterator = base_col_iterator<const value_type>;
 
 private:
+  // smallest share of work worth a thread of its own; in a product every thread packs all of right
+  static constexpr size_t PAR_MIN_ELEMENTS = size_t(1) << 15;
+  static constexpr size_t PAR_MIN_ROWS = 64;
+  static constexpr size_t PAR_MIN_FLOPS = size_t(1) << 22;
+
   size_t _cols;
   size_t _rows;
   pointer _data;
@@ -170,6 +181,17 @@ public:
     std::copy(other.data(), other.data() + size(), data());
   }
 
+  matrix(matrix&& other) noexcept : matrix() {
+    swap(*this, other);
+  }
+
+  // evaluates a lazy expression built by the arithmetic operators in a single pass
+  template <typename E>
+    requires (matrix_expr::operand_of<E, matrix> && !std::is_same_v<E, matrix>)
+  matrix(const E& expr) : matrix(expr.rows(), expr.cols()) {
+    matrix_expr::assign(expr, data(), size());
+  }
+
   ~matrix() {
     delete[] _data;
   }
@@ -183,6 +205,25 @@ public:
     return *this;
   }
 
+  matrix& operator=(matrix&& other) noexcept {
+    matrix tmp(std::move(other));
+    swap(*this, tmp);
+    return *this;
+  }
+
+  // reuses the storage when the shape matches and no product reads from it
+  template <typename E>
+    requires (matrix_expr::operand_of<E, matrix> && !std::is_same_v<E, matrix>)
+  matrix& operator=(const E& expr) {
+    if (expr.rows() != rows() || expr.cols() != cols() || expr.aliases(*this)) {
+      matrix res(expr);
+      swap(*this, res);
+    } else {
+      matrix_expr::assign(expr, data(), size());
+    }
+    return *this;
+  }
+
   friend void swap(matrix& left, matrix& right) {
     std::swap(left._cols, right._cols);
     std::swap(left._rows, right._rows);
@@ -240,6 +281,23 @@ public:
     return *this;
   }
 
+  template <typename E>
+    requires (matrix_expr::operand_of<E, matrix> && !std::is_same_v<E, matrix>)
+  matrix& operator+=(const E& expr) {
+    if (expr.aliases(*this)) {
+      return *this += matrix(expr);
+    }
+    matrix_expr::add_assign(expr, data(), size());
+    return *this;
+  }
+
+  template <typename E>
+    requires (matrix_expr::operand_of<E, matrix> && !std::is_same_v<E, matrix>)
+  matrix& operator-=(const E& expr) {
+    matrix_expr::subtract_assign(expr, data(), size());
+    return *this;
+  }
+
   matrix& operator*=(const matrix& other) {
     matrix res = *this * other;
     swap(*this, res);
@@ -251,30 +309,73 @@ public:
     return *this;
   }
 
-  friend matrix operator+(const matrix& left, const matrix& right) {
-    return matrix(left) += right;
+  // element-wise and product operations split across threads by rows or element ranges
+  matrix& add(const matrix& other, const matrix_parallel::parallel_policy& policy) {
+    matrix_parallel::for_each_chunk(policy, size(), PAR_MIN_ELEMENTS, [&](size_t first, size_t last) {
+      std::transform(begin() + first, begin() + last, other.begin() + first, begin() + first, std::plus());
+    });
+    return *this;
+  }
+
+  matrix& subtract(const matrix& other, const matrix_parallel::parallel_policy& policy) {
+    matrix_parallel::for_each_chunk(policy, size(), PAR_MIN_ELEMENTS, [&](size_t first, size_t last) {
+      std::transform(begin() + first, begin() + last, other.begin() + first, begin() + first, std::minus());
+    });
+    return *this;
   }
 
-  friend matrix operator-(const matrix& left, const matrix& right) {
-    return matrix(left) -= right;
+  matrix& scale(const_reference factor, const matrix_parallel::parallel_policy& policy) {
+    matrix_parallel::for_each_chunk(policy, size(), PAR_MIN_ELEMENTS, [&](size_t first, size_t last) {
+      std::transform(begin() + first, begin() + last, begin() + first,
+                     [&factor](value_type val) { return val * factor; });
+    });
+    return *this;
   }
 
-  friend matrix operator*(const matrix& left, const matrix& right) {
+  friend matrix multiply(const matrix& left, const matrix& right, const matrix_parallel::parallel_policy& policy) {
     matrix res(left.rows(), right.cols());
-    for (size_t row = 0; row < left.rows(); ++row) {
-      for (size_t col = 0; col < right.cols(); ++col) {
-        res(row, col) = std::inner_product(left.row_begin(row), left.row_end(row), right.col_begin(col), value_type());
-      }
+    if (res.empty()) {
+      return res;
     }
+    size_t inner = left.cols() * right.cols();
+    size_t min_rows = std::max(PAR_MIN_ROWS, PAR_MIN_FLOPS / inner);
+    matrix_parallel::for_each_chunk(policy, res.rows(), min_rows, [&](size_t first, size_t last) {
+      matrix_gemm::multiply(left.row_begin(first), right.data(), res.row_begin(first), last - first, left.cols(),
+                            right.cols());
+    });
     return res;
   }
 
-  friend matrix operator*(const_reference factor, const matrix& right) {
-    return matrix(right) *= factor;
+  // the arithmetic operators return lazy expressions, see matrix-expr.h;
+  // temporary operands are moved into the expression, named ones are referenced
+  template <typename L, typename R>
+    requires (std::is_same_v<std::remove_cvref_t<L>, matrix> && std::is_same_v<std::remove_cvref_t<R>, matrix>)
+  friend auto operator+(L&& left, R&& right) {
+    return matrix_expr::make_elementwise<std::plus<>>(std::forward<L>(left), std::forward<R>(right));
+  }
+
+  template <typename L, typename R>
+    requires (std::is_same_v<std::remove_cvref_t<L>, matrix> && std::is_same_v<std::remove_cvref_t<R>, matrix>)
+  friend auto operator-(L&& left, R&& right) {
+    return matrix_expr::make_elementwise<std::minus<>>(std::forward<L>(left), std::forward<R>(right));
+  }
+
+  template <typename L, typename R>
+    requires (std::is_same_v<std::remove_cvref_t<L>, matrix> && std::is_same_v<std::remove_cvref_t<R>, matrix>)
+  friend auto operator*(L&& left, R&& right) {
+    return matrix_expr::make_product(std::forward<L>(left), std::forward<R>(right));
+  }
+
+  template <typename M>
+    requires std::is_same_v<std::remove_cvref_t<M>, matrix>
+  friend auto operator*(const_reference factor, M&& right) {
+    return matrix_expr::make_scaled(std::forward<M>(right), factor);
   }
 
-  friend matrix operator*(const matrix& left, const_reference factor) {
-    return matrix(left) *= factor;
+  template <typename M>
+    requires std::is_same_v<std::remove_cvref_t<M>, matrix>
+  friend auto operator*(M&& left, const_reference factor) {
+    return matrix_expr::make_scaled(std::forward<M>(left), factor);
   }
 
   iterator begin() {
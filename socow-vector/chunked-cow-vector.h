@@ -0,0 +1,384 @@
+#pragma once
+
+#include "socow-vector.h"
+
+#include <algorithm>
+#include <bit>
+#include <compare>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// copy-on-write vector split into refcounted chunks of CHUNK_BYTES: copies share every chunk,
+// and a write copies only the chunk it touches instead of the whole buffer
+template <typename T, std::size_t CHUNK_BYTES = 4096, typename RefCount = socow_components::plain_refcount>
+class chunked_cow_vector {
+public:
+  // power of two, so that element lookup is a shift and a mask
+  static constexpr size_t CHUNK_SIZE = std::bit_floor(std::max<size_t>(1, CHUNK_BYTES / sizeof(T)));
+
+private:
+  template <bool CONST>
+  class basic_iterator;
+
+public:
+  using value_type = T;
+  using reference = T&;
+  using const_reference = const T&;
+  using pointer = T*;
+  using const_pointer = const T*;
+  using iterator = basic_iterator<false>;
+  using const_iterator = basic_iterator<true>;
+
+private:
+  struct chunk {
+  private:
+    RefCount _count;
+
+    T _data[0];
+    friend chunked_cow_vector;
+
+    chunk() noexcept
+        : _count(1) {}
+  };
+
+  // chunks past the last element are empty and owned by this vector only
+  std::vector<chunk*> _chunks;
+  size_t _size;
+
+  static chunk* get_chunk() {
+    return new (operator new(sizeof(chunk) + CHUNK_SIZE * sizeof(T))) chunk();
+  }
+
+  static void release_chunk(chunk* cur_chunk, size_t count) noexcept {
+    if (cur_chunk->_count.release()) {
+      std::destroy_n(cur_chunk->_data, count);
+      operator delete(cur_chunk);
+    }
+  }
+
+  // number of constructed elements in the index-th chunk
+  size_t chunk_count(size_t index) const noexcept {
+    size_t first = index * CHUNK_SIZE;
+    return _size <= first ? 0 : std::min(CHUNK_SIZE, _size - first);
+  }
+
+  size_t used_chunks() const noexcept {
+    return (_size + CHUNK_SIZE - 1) / CHUNK_SIZE;
+  }
+
+  chunk* unshare(size_t index) {
+    chunk* cur_chunk = _chunks[index];
+    if (cur_chunk->_count.unique()) {
+      return cur_chunk;
+    }
+    chunk* new_chunk = get_chunk();
+    size_t count = chunk_count(index);
+    try {
+      std::uninitialized_copy_n(cur_chunk->_data, count, new_chunk->_data);
+    } catch (...) {
+      operator delete(new_chunk);
+      throw;
+    }
+    release_chunk(cur_chunk, count);
+    _chunks[index] = new_chunk;
+    return new_chunk;
+  }
+
+  template <typename F1 = decltype([]() {})>
+  void abstract_push_back(F1 get_reference) {
+    if (size() == capacity()) {
+      _chunks.push_back(nullptr);
+      try {
+        _chunks.back() = get_chunk();
+      } catch (...) {
+        _chunks.pop_back();
+        throw;
+      }
+    }
+    chunk* last = unshare(size() / CHUNK_SIZE);
+    new (last->_data + size() % CHUNK_SIZE) T(get_reference());
+    ++_size;
+  }
+
+public:
+  chunked_cow_vector() noexcept
+      : _size(0) {}
+
+  chunked_cow_vector(const chunked_cow_vector& other)
+      : _chunks(other._chunks.begin(), other._chunks.begin() + other.used_chunks())
+      , _size(other.size()) {
+    for (chunk* cur_chunk : _chunks) {
+      cur_chunk->_count.acquire();
+    }
+  }
+
+  chunked_cow_vector(chunked_cow_vector&& other) noexcept
+      : _chunks(std::move(other._chunks))
+      , _size(other.size()) {
+    other._chunks.clear();
+    other._size = 0;
+  }
+
+  chunked_cow_vector& operator=(const chunked_cow_vector& other) {
+    if (this == &other) {
+      return *this;
+    }
+    chunked_cow_vector temp(other);
+    swap(temp);
+    return *this;
+  }
+
+  chunked_cow_vector& operator=(chunked_cow_vector&& other) noexcept {
+    if (this == &other) {
+      return *this;
+    }
+    clear();
+    swap(other);
+    return *this;
+  }
+
+  ~chunked_cow_vector() noexcept {
+    clear();
+  }
+
+  reference operator[](size_t index) {
+    return unshare(index / CHUNK_SIZE)->_data[index % CHUNK_SIZE];
+  }
+
+  const_reference operator[](size_t index) const noexcept {
+    return _chunks[index / CHUNK_SIZE]->_data[index % CHUNK_SIZE];
+  }
+
+  size_t size() const noexcept {
+    return _size;
+  }
+
+  reference front() {
+    return (*this)[0];
+  }
+
+  const_reference front() const noexcept {
+    return (*this)[0];
+  }
+
+  reference back() {
+    return (*this)[size() - 1];
+  }
+
+  const_reference back() const noexcept {
+    return (*this)[size() - 1];
+  }
+
+  void push_back(T&& value) {
+    abstract_push_back([&value]() mutable -> T&& { return std::move(value); });
+  }
+
+  void push_back(const T& value) {
+    abstract_push_back([&value]() mutable -> const T& { return value; });
+  }
+
+  void pop_back() {
+    chunk* last = unshare((size() - 1) / CHUNK_SIZE);
+    last->_data[(size() - 1) % CHUNK_SIZE].~T();
+    --_size;
+  }
+
+  bool empty() const noexcept {
+    return size() == 0;
+  }
+
+  size_t capacity() const noexcept {
+    return _chunks.size() * CHUNK_SIZE;
+  }
+
+  void reserve(size_t new_capacity) {
+    size_t count = (new_capacity + CHUNK_SIZE - 1) / CHUNK_SIZE;
+    if (count <= _chunks.size()) {
+      return;
+    }
+    _chunks.reserve(count);
+    while (_chunks.size() < count) {
+      _chunks.push_back(get_chunk());
+    }
+  }
+
+  void shrink_to_fit() {
+    size_t count = used_chunks();
+    for (size_t i = count; i < _chunks.size(); ++i) {
+      release_chunk(_chunks[i], 0);
+    }
+    _chunks.resize(count);
+    _chunks.shrink_to_fit();
+  }
+
+  void clear() noexcept {
+    for (size_t i = 0; i < _chunks.size(); ++i) {
+      release_chunk(_chunks[i], chunk_count(i));
+    }
+    _chunks.clear();
+    _size = 0;
+  }
+
+  void swap(chunked_cow_vector& other) noexcept {
+    std::swap(_chunks, other._chunks);
+    std::swap(_size, other._size);
+  }
+
+  // dereferencing a mutable iterator unshares the chunk it points into
+  iterator begin() noexcept {
+    return {this, 0};
+  }
+
+  iterator end() noexcept {
+    return {this, size()};
+  }
+
+  const_iterator begin() const noexcept {
+    return {this, 0};
+  }
+
+  const_iterator end() const noexcept {
+    return {this, size()};
+  }
+
+  const_iterator cbegin() const noexcept {
+    return begin();
+  }
+
+  const_iterator cend() const noexcept {
+    return end();
+  }
+
+  iterator insert(const_iterator it, const T& value) {
+    size_t pos = it._index;
+    push_back(value);
+    std::rotate(begin() + pos, end() - 1, end());
+    return begin() + pos;
+  }
+
+  iterator insert(const_iterator it, T&& value) {
+    size_t pos = it._index;
+    push_back(std::move(value));
+    std::rotate(begin() + pos, end() - 1, end());
+    return begin() + pos;
+  }
+
+  iterator erase(const_iterator it) {
+    return erase(it, it + 1);
+  }
+
+  iterator erase(const_iterator first, const_iterator last) {
+    size_t posl = first._index, posr = last._index;
+    if (posl != posr) {
+      std::move(begin() + posr, end(), begin() + posl);
+      for (size_t i = posl; i < posr; ++i) {
+        pop_back();
+      }
+    }
+    return begin() + posl;
+  }
+};
+
+template <typename T, std::size_t CHUNK_BYTES, typename RefCount>
+template <bool CONST>
+class chunked_cow_vector<T, CHUNK_BYTES, RefCount>::basic_iterator {
+  using owner = std::conditional_t<CONST, const chunked_cow_vector, chunked_cow_vector>;
+
+public:
+  using iterator_category = std::random_access_iterator_tag;
+  using value_type = T;
+  using difference_type = std::ptrdiff_t;
+  using reference = std::conditional_t<CONST, const T&, T&>;
+  using pointer = std::conditional_t<CONST, const T*, T*>;
+
+  basic_iterator() = default;
+
+  operator basic_iterator<true>() const noexcept
+    requires(!CONST)
+  {
+    return {_owner, _index};
+  }
+
+  reference operator*() const {
+    return (*_owner)[_index];
+  }
+
+  pointer operator->() const {
+    return &**this;
+  }
+
+  reference operator[](difference_type n) const {
+    return (*_owner)[_index + n];
+  }
+
+  basic_iterator& operator++() noexcept {
+    ++_index;
+    return *this;
+  }
+
+  basic_iterator operator++(int) noexcept {
+    basic_iterator res = *this;
+    ++_index;
+    return res;
+  }
+
+  basic_iterator& operator--() noexcept {
+    --_index;
+    return *this;
+  }
+
+  basic_iterator operator--(int) noexcept {
+    basic_iterator res = *this;
+    --_index;
+    return res;
+  }
+
+  basic_iterator& operator+=(difference_type n) noexcept {
+    _index += n;
+    return *this;
+  }
+
+  basic_iterator& operator-=(difference_type n) noexcept {
+    _index -= n;
+    return *this;
+  }
+
+  friend basic_iterator operator+(basic_iterator it, difference_type n) noexcept {
+    return it += n;
+  }
+
+  friend basic_iterator operator+(difference_type n, basic_iterator it) noexcept {
+    return it += n;
+  }
+
+  friend basic_iterator operator-(basic_iterator it, difference_type n) noexcept {
+    return it -= n;
+  }
+
+  friend difference_type operator-(const basic_iterator& lhs, const basic_iterator& rhs) noexcept {
+    return static_cast<difference_type>(lhs._index) - static_cast<difference_type>(rhs._index);
+  }
+
+  friend bool operator==(const basic_iterator& lhs, const basic_iterator& rhs) noexcept {
+    return lhs._index == rhs._index;
+  }
+
+  friend std::strong_ordering operator<=>(const basic_iterator& lhs, const basic_iterator& rhs) noexcept {
+    return lhs._index <=> rhs._index;
+  }
+
+private:
+  owner* _owner = nullptr;
+  size_t _index = 0;
+
+  basic_iterator(owner* cur_owner, size_t index) noexcept
+      : _owner(cur_owner)
+      , _index(index) {}
+
+  friend chunked_cow_vector;
+  friend basic_iterator<!CONST>;
+};
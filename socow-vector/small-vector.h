@@ -0,0 +1,290 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// socow_vector storage without sharing: elements live in the inline buffer until they outgrow it,
+// _ptr always points to the live buffer, so element access never checks which one it is
+template <typename T, std::size_t SMALL_SIZE>
+class small_vector {
+public:
+  using value_type = T;
+  using reference = T&;
+  using const_reference = const T&;
+  using pointer = T*;
+  using const_pointer = const T*;
+  using iterator = pointer;
+  using const_iterator = const_pointer;
+
+private:
+  pointer _ptr;
+  size_t _size;
+  size_t _capacity;
+
+  union {
+    T _data[SMALL_SIZE];
+  };
+
+  bool is_small() const noexcept {
+    return _ptr == _data;
+  }
+
+  void free_buffer() noexcept {
+    if (!is_small()) {
+      operator delete(_ptr);
+    }
+  }
+
+  // moves the elements unless moving may throw and copying is possible, so the source stays intact on failure
+  void relocate_to(pointer dest) {
+    if constexpr (std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>) {
+      std::uninitialized_move_n(_ptr, size(), dest);
+    } else {
+      std::uninitialized_copy_n(_ptr, size(), dest);
+    }
+  }
+
+  // switches to the inline buffer if new_capacity fits in it
+  void reallocate(size_t new_capacity) {
+    bool to_small = new_capacity <= SMALL_SIZE;
+    if (to_small && is_small()) {
+      return;
+    }
+    pointer new_ptr = to_small ? _data : static_cast<pointer>(operator new(new_capacity * sizeof(T)));
+    try {
+      relocate_to(new_ptr);
+    } catch (...) {
+      if (!to_small) {
+        operator delete(new_ptr);
+      }
+      throw;
+    }
+    std::destroy_n(_ptr, size());
+    free_buffer();
+    _ptr = new_ptr;
+    _capacity = to_small ? SMALL_SIZE : new_capacity;
+  }
+
+  void take(small_vector& other) noexcept(std::is_nothrow_move_constructible_v<T>) {
+    if (other.is_small()) {
+      std::uninitialized_move_n(other._data, other.size(), _data);
+      std::destroy_n(other._data, other.size());
+    } else {
+      _ptr = other._ptr;
+      _capacity = other._capacity;
+      other._ptr = other._data;
+      other._capacity = SMALL_SIZE;
+    }
+    _size = other.size();
+    other._size = 0;
+  }
+
+public:
+  small_vector() noexcept
+      : _ptr(_data)
+      , _size(0)
+      , _capacity(SMALL_SIZE) {}
+
+  // delegates to the default constructor, so on a throwing copy the destructor releases the buffer
+  small_vector(const small_vector& other)
+      : small_vector() {
+    reserve(other.size());
+    std::uninitialized_copy_n(other.data(), other.size(), _ptr);
+    _size = other.size();
+  }
+
+  small_vector(small_vector&& other) noexcept(std::is_nothrow_move_constructible_v<T>)
+      : small_vector() {
+    take(other);
+  }
+
+  small_vector& operator=(const small_vector& other) {
+    if (this == &other) {
+      return *this;
+    }
+    small_vector temp(other);
+    swap(temp);
+    return *this;
+  }
+
+  small_vector& operator=(small_vector&& other) noexcept(std::is_nothrow_move_constructible_v<T>) {
+    if (this == &other) {
+      return *this;
+    }
+    clear();
+    free_buffer();
+    _ptr = _data;
+    _capacity = SMALL_SIZE;
+    take(other);
+    return *this;
+  }
+
+  ~small_vector() noexcept {
+    std::destroy_n(_ptr, size());
+    free_buffer();
+  }
+
+  reference operator[](size_t index) noexcept {
+    return _ptr[index];
+  }
+
+  const_reference operator[](size_t index) const noexcept {
+    return _ptr[index];
+  }
+
+  pointer data() noexcept {
+    return _ptr;
+  }
+
+  const_pointer data() const noexcept {
+    return _ptr;
+  }
+
+  size_t size() const noexcept {
+    return _size;
+  }
+
+  reference front() noexcept {
+    return _ptr[0];
+  }
+
+  const_reference front() const noexcept {
+    return _ptr[0];
+  }
+
+  reference back() noexcept {
+    return _ptr[size() - 1];
+  }
+
+  const_reference back() const noexcept {
+    return _ptr[size() - 1];
+  }
+
+  // the new element is built before the old ones move, so args may refer into the vector
+  template <typename... Args>
+  reference emplace_back(Args&&... args) {
+    if (size() != capacity()) {
+      new (_ptr + size()) T(std::forward<Args>(args)...);
+      return _ptr[_size++];
+    }
+    size_t new_capacity = 2 * capacity() + 1;
+    pointer new_ptr = static_cast<pointer>(operator new(new_capacity * sizeof(T)));
+    try {
+      new (new_ptr + size()) T(std::forward<Args>(args)...);
+      try {
+        relocate_to(new_ptr);
+      } catch (...) {
+        new_ptr[size()].~T();
+        throw;
+      }
+    } catch (...) {
+      operator delete(new_ptr);
+      throw;
+    }
+    std::destroy_n(_ptr, size());
+    free_buffer();
+    _ptr = new_ptr;
+    _capacity = new_capacity;
+    return _ptr[_size++];
+  }
+
+  void push_back(T&& value) {
+    emplace_back(std::move(value));
+  }
+
+  void push_back(const T& value) {
+    emplace_back(value);
+  }
+
+  void pop_back() noexcept {
+    _ptr[--_size].~T();
+  }
+
+  bool empty() const noexcept {
+    return size() == 0;
+  }
+
+  size_t capacity() const noexcept {
+    return _capacity;
+  }
+
+  void reserve(size_t new_capacity) {
+    if (new_capacity > capacity()) {
+      reallocate(new_capacity);
+    }
+  }
+
+  void shrink_to_fit() {
+    if (!is_small() && size() != capacity()) {
+      reallocate(size());
+    }
+  }
+
+  void clear() noexcept {
+    std::destroy_n(_ptr, size());
+    _size = 0;
+  }
+
+  void swap(small_vector& other) noexcept(std::is_nothrow_move_constructible_v<T>) {
+    if (this == &other) {
+      return;
+    }
+    if (!is_small() && !other.is_small()) {
+      std::swap(_ptr, other._ptr);
+      std::swap(_size, other._size);
+      std::swap(_capacity, other._capacity);
+      return;
+    }
+    small_vector tmp(std::move(other));
+    other = std::move(*this);
+    (*this) = std::move(tmp);
+  }
+
+  iterator begin() noexcept {
+    return _ptr;
+  }
+
+  iterator end() noexcept {
+    return _ptr + size();
+  }
+
+  const_iterator begin() const noexcept {
+    return _ptr;
+  }
+
+  const_iterator end() const noexcept {
+    return _ptr + size();
+  }
+
+  iterator insert(const_iterator it, const T& value) {
+    size_t pos = it - begin();
+    push_back(value);
+    std::rotate(begin() + pos, end() - 1, end());
+    return begin() + pos;
+  }
+
+  iterator insert(const_iterator it, T&& value) {
+    size_t pos = it - begin();
+    push_back(std::move(value));
+    std::rotate(begin() + pos, end() - 1, end());
+    return begin() + pos;
+  }
+
+  iterator erase(const_iterator it) {
+    return erase(it, it + 1);
+  }
+
+  iterator erase(const_iterator first, const_iterator last) {
+    size_t posl = first - begin(), posr = last - begin();
+    if (posl != posr) {
+      std::move(begin() + posr, end(), begin() + posl);
+      std::destroy(end() - (posr - posl), end());
+      _size -= posr - posl;
+    }
+    return begin() + posl;
+  }
+};
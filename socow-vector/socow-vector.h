@@ -1,13 +1,74 @@
 #pragma once
 
 #include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <cstddef>
 #include <functional>
 #include <memory>
+#include <span>
 
-template <typename T, std::size_t SMALL_SIZE>
-class socow_vector {
+namespace socow_components {
+
+// owner count of a shared buffer, copies holding it must stay on one thread
+struct plain_refcount {
+  explicit plain_refcount(size_t count) noexcept
+      : _count(count) {}
+
+  void acquire() noexcept {
+    ++_count;
+  }
+
+  // true when the caller was the last owner
+  bool release() noexcept {
+    return --_count == 0;
+  }
+
+  bool unique() const noexcept {
+    return _count == 1;
+  }
+
+private:
+  size_t _count;
+};
+
+// copies holding the buffer may live on different threads: releases publish the owner's reads and writes,
+// and whoever observes itself as the last owner acquires them before destroying or mutating the buffer
+struct atomic_refcount {
+  explicit atomic_refcount(size_t count) noexcept
+      : _count(count) {}
+
+  void acquire() noexcept {
+    _count.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  bool release() noexcept {
+    return _count.fetch_sub(1, std::memory_order_acq_rel) == 1;
+  }
+
+  bool unique() const noexcept {
+    return _count.load(std::memory_order_acquire) == 1;
+  }
+
+private:
+  std::atomic<size_t> _count;
+};
+
+inline constexpr std::size_t CACHE_LINE = 64;
+
+// the largest inline capacity that keeps socow_vector<T, N> within BYTES, at least one element
+template <typename T, std::size_t BYTES>
+inline constexpr std::size_t inline_capacity = std::max<std::size_t>(1, (BYTES - sizeof(std::size_t)) / sizeof(T));
+
+} // namespace socow_components
+
+// ALIGN raises the alignment of the whole object, so that one sized to whole cache lines also starts on one
+template <
+    typename T,
+    std::size_t SMALL_SIZE,
+    typename RefCount = socow_components::plain_refcount,
+    std::size_t ALIGN = alignof(std::size_t)>
+class alignas(std::max({ALIGN, alignof(std::size_t), alignof(T)})) socow_vector {
 public:
   using value_type = T;
   using reference = T&;
@@ -21,17 +82,20 @@ private:
   struct impl {
   private:
     size_t _capacity;
-    size_t _count;
+    RefCount _count;
 
     T _data[0];
     friend socow_vector;
 
-    impl()
-        : _count(1) {}
+    explicit impl(size_t capacity) noexcept
+        : _capacity(capacity)
+        , _count(1) {}
   };
 
-  size_t _size;
-  bool _small;
+  static constexpr size_t SMALL_FLAG = 1;
+
+  // size in the upper bits and the small flag in the lowest one, so no padding is spent on the flag
+  size_t _state;
 
   union {
     impl* _impl;
@@ -39,22 +103,22 @@ private:
   };
 
   bool is_small() const noexcept {
-    return _small;
+    return _state & SMALL_FLAG;
+  }
+
+  void set_size(size_t new_size) noexcept {
+    _state = (new_size << 1) | (_state & SMALL_FLAG);
   }
 
   static void decrease_impl(impl* cur_impl, size_t sz) noexcept {
-    cur_impl->_count--;
-    if (cur_impl->_count == 0) {
+    if (cur_impl->_count.release()) {
       std::destroy_n(cur_impl->_data, sz);
       operator delete(cur_impl);
     }
   }
 
   static impl* get_shared_buff(size_t capacity) {
-    impl* res = static_cast<impl*>(operator new(sizeof(impl) + capacity * sizeof(T)));
-    res->_count = 1;
-    res->_capacity = capacity;
-    return res;
+    return new (operator new(sizeof(impl) + capacity * sizeof(T))) impl(capacity);
   }
 
   const_pointer get_data() const noexcept {
@@ -71,8 +135,7 @@ private:
     } else {
       decrease_impl(_impl, size());
     }
-    _size = 0;
-    _small = true;
+    _state = SMALL_FLAG;
   }
 
   // used for shared vector
@@ -102,12 +165,12 @@ private:
     std::uninitialized_move_n(_data, size(), new_impl->_data);
     std::destroy_n(_data, size());
     _impl = new_impl;
-    _small = false;
+    _state &= ~SMALL_FLAG;
   }
 
   void make_small(size_t newsz) {
     impl* cur_impl = _impl;
-    if (cur_impl->_count == 1) {
+    if (cur_impl->_count.unique()) {
       std::uninitialized_move_n(cur_impl->_data, newsz, _data);
     } else {
       try {
@@ -118,13 +181,12 @@ private:
       }
     }
     decrease_impl(cur_impl, size());
-    _small = true;
-    _size = newsz;
+    _state = (newsz << 1) | SMALL_FLAG;
   }
 
   template <typename F1 = decltype([]() {})>
   void abstract_push_back(F1 get_reference) {
-    if (!is_small() && _impl->_count != 1) {
+    if (!is_small() && !_impl->_count.unique()) {
       resize(size() + 1);
     }
     if (size() == capacity()) {
@@ -132,28 +194,26 @@ private:
       temp.reserve(2 * capacity() + 1);
       new (temp.get_data() + size()) T(get_reference());
       std::uninitialized_move_n(get_data(), size(), temp.get_data());
-      temp._size = size() + 1;
+      temp.set_size(size() + 1);
       destroy();
       temp.swap(*this);
     } else {
       new (get_data() + size()) T(get_reference());
-      ++_size;
+      set_size(size() + 1);
     }
   }
 
 public:
   socow_vector() noexcept
-      : _size(0)
-      , _small(true) {}
+      : _state(SMALL_FLAG) {}
 
   socow_vector(const socow_vector& other) {
-    _size = other.size();
-    _small = other._small;
+    _state = other._state;
     if (other.is_small()) {
       std::uninitialized_copy_n(other._data, size(), _data);
     } else {
       _impl = other._impl;
-      _impl->_count++;
+      _impl->_count.acquire();
     }
   }
 
@@ -183,10 +243,8 @@ public:
     } else {
       _impl = other._impl;
     }
-    _size = other.size();
-    _small = other._small;
-    other._size = 0;
-    other._small = true;
+    _state = other._state;
+    other._state = SMALL_FLAG;
     return *this;
   }
 
@@ -203,7 +261,7 @@ public:
   }
 
   pointer data() {
-    if (!is_small() && _impl->_count != 1) {
+    if (!is_small() && !_impl->_count.unique()) {
       if (size() <= SMALL_SIZE) {
         make_small(size());
       } else {
@@ -217,8 +275,17 @@ public:
     return get_data();
   }
 
+  // read-only accessors never unshare, even on a non-const vector
+  const_pointer cdata() const noexcept {
+    return get_data();
+  }
+
+  std::span<const T> cview() const noexcept {
+    return {get_data(), size()};
+  }
+
   size_t size() const noexcept {
-    return _size;
+    return _state >> 1;
   }
 
   reference front() {
@@ -261,13 +328,13 @@ public:
     if (is_small() && new_capacity > capacity()) {
       make_big(new_capacity);
     } else if (!is_small()) {
-      if (_impl->_count != 1 && new_capacity > size()) {
+      if (!_impl->_count.unique() && new_capacity > size()) {
         if (new_capacity <= SMALL_SIZE) {
           make_small(size());
         } else {
           resize(new_capacity);
         }
-      } else if (_impl->_count == 1 && new_capacity > capacity()) {
+      } else if (_impl->_count.unique() && new_capacity > capacity()) {
         move_resize(new_capacity);
       }
     }
@@ -276,7 +343,7 @@ public:
   void shrink_to_fit() {
     if (!is_small() && size() != capacity()) {
       if (size() > SMALL_SIZE) {
-        if (_impl->_count != 1) {
+        if (!_impl->_count.unique()) {
           resize(size());
         } else {
           move_resize(size());
@@ -291,9 +358,9 @@ public:
     if (empty()) {
       return;
     }
-    if (is_small() || _impl->_count == 1) {
+    if (is_small() || _impl->_count.unique()) {
       std::destroy_n(get_data(), size());
-      _size = 0;
+      set_size(0);
     } else {
       destroy();
     }
@@ -328,6 +395,14 @@ public:
     return begin() + size();
   }
 
+  const_iterator cbegin() const noexcept {
+    return get_data();
+  }
+
+  const_iterator cend() const noexcept {
+    return get_data() + size();
+  }
+
   iterator insert(const_iterator it, const T& value) {
     size_t pos = it - get_data();
     push_back(value);
@@ -352,10 +427,10 @@ public:
       return begin() + dist;
     }
     size_t posl = first - get_data(), posr = last - get_data();
-    if (is_small() || _impl->_count == 1) {
+    if (is_small() || _impl->_count.unique()) {
       std::rotate(begin() + posl, begin() + posr, end());
       std::destroy(end() + posl - posr, end());
-      _size -= posr - posl;
+      set_size(size() - (posr - posl));
     } else {
       socow_vector tmp;
       tmp.reserve(size() + posl - posr);
@@ -370,3 +445,25 @@ public:
     return get_data() + posl;
   }
 };
+
+// copies of a big vector may be handed to other threads, each unshares on its first write
+template <typename T, std::size_t SMALL_SIZE>
+using shared_socow_vector = socow_vector<T, SMALL_SIZE, socow_components::atomic_refcount>;
+
+// inline capacity derived so that the vector fits in CACHE_LINES cache lines, filling them for small T,
+// and aligned so that it never straddles one more line than that
+template <typename T, std::size_t CACHE_LINES = 1, typename RefCount = socow_components::plain_refcount>
+using compact_socow_vector = socow_vector<
+    T,
+    socow_components::inline_capacity<T, CACHE_LINES * socow_components::CACHE_LINE>,
+    RefCount,
+    socow_components::CACHE_LINE>;
+
+static_assert(sizeof(socow_vector<int, 2>) == 2 * sizeof(std::size_t));
+static_assert(sizeof(compact_socow_vector<char>) == socow_components::CACHE_LINE);
+static_assert(sizeof(compact_socow_vector<int>) == socow_components::CACHE_LINE);
+static_assert(sizeof(compact_socow_vector<void*>) == socow_components::CACHE_LINE);
+static_assert(sizeof(compact_socow_vector<double, 2>) == 2 * socow_components::CACHE_LINE);
+static_assert(alignof(socow_vector<int, 2>) == alignof(std::size_t));
+static_assert(alignof(compact_socow_vector<char>) == socow_components::CACHE_LINE);
+static_assert(alignof(compact_socow_vector<double, 2>) == socow_components::CACHE_LINE);
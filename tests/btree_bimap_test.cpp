@@ -0,0 +1,170 @@
+#include "../bimap/bimap.h"
+
+#include <cassert>
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+struct allocation_stats {
+  std::size_t allocations = 0;
+  std::size_t live = 0;
+};
+
+// counts every allocation made through any rebind of it
+template <typename T>
+class counting_allocator {
+  template <typename U>
+  friend class counting_allocator;
+
+public:
+  using value_type = T;
+
+  explicit counting_allocator(allocation_stats* stats) noexcept
+      : stats_(stats) {}
+
+  template <typename U>
+  counting_allocator(const counting_allocator<U>& other) noexcept
+      : stats_(other.stats_) {}
+
+  T* allocate(std::size_t n) {
+    ++stats_->allocations;
+    ++stats_->live;
+    return std::allocator<T>().allocate(n);
+  }
+
+  void deallocate(T* ptr, std::size_t n) noexcept {
+    --stats_->live;
+    std::allocator<T>().deallocate(ptr, n);
+  }
+
+  template <typename U>
+  friend bool operator==(const counting_allocator& l, const counting_allocator<U>& r) noexcept {
+    return l.stats_ == r.stats_;
+  }
+
+private:
+  allocation_stats* stats_;
+};
+
+template <std::size_t Degree>
+using counted_bimap = bimap<
+    int,
+    int,
+    std::less<int>,
+    std::less<int>,
+    bimap_components::btree_storage<Degree>,
+    counting_allocator<std::pair<int, int>>>;
+
+// entries and tree nodes of both sides all come from the allocator and all go back to it
+void nodes_use_allocator() {
+  allocation_stats stats;
+  {
+    counting_allocator<std::pair<int, int>> alloc(&stats);
+    counted_bimap<2> b(std::less<int>(), std::less<int>(), alloc);
+    for (int i = 0; i < 1000; ++i) {
+      b.insert(i, -i);
+    }
+    assert(stats.allocations > 1000 + 2 * (1000 / 3));
+    counted_bimap<2> copy = b;
+    assert(copy == b);
+    for (int i = 0; i < 1000; i += 2) {
+      b.erase_left(i);
+    }
+    std::vector<std::pair<int, int>> pairs{{1, 1}, {2, 2}, {3, 3}};
+    copy.assign(pairs.begin(), pairs.end());
+    assert(copy.size() == 3);
+  }
+  assert(stats.live == 0);
+}
+
+void pool_serves_nodes() {
+  using pooled = bimap<
+      int,
+      int,
+      std::less<int>,
+      std::less<int>,
+      bimap_components::btree_storage<3>,
+      pool_allocator<std::pair<int, int>>>;
+  pooled a;
+  for (int i = 0; i < 500; ++i) {
+    a.insert(i, 500 - i);
+  }
+  pooled b = a;
+  pooled c;
+  c = std::move(b);
+  swap(a, c);
+  assert(a == c);
+  for (int i = 0; i < 500; ++i) {
+    assert(a.at_left(i) == 500 - i);
+  }
+}
+
+void matches_model() {
+  std::mt19937 rng(7);
+  allocation_stats stats;
+  {
+    counting_allocator<std::pair<int, int>> alloc(&stats);
+    counted_bimap<3> b(std::less<int>(), std::less<int>(), alloc);
+    std::map<int, int> left;
+    std::map<int, int> right;
+    for (int i = 0; i < 20000; ++i) {
+      int l = static_cast<int>(rng() % 500);
+      int r = static_cast<int>(rng() % 500);
+      if (rng() % 3 != 0) {
+        bool fresh = left.count(l) == 0 && right.count(r) == 0;
+        assert((b.insert(l, r) != b.end_left()) == fresh);
+        if (fresh) {
+          left[l] = r;
+          right[r] = l;
+        }
+      } else {
+        auto it = left.find(l);
+        assert(b.erase_left(l) == (it != left.end()));
+        if (it != left.end()) {
+          right.erase(it->second);
+          left.erase(it);
+        }
+      }
+    }
+    assert(b.size() == left.size());
+    for (auto [l, r] : left) {
+      assert(b.at_left(l) == r);
+      assert(b.at_right(r) == l);
+    }
+  }
+  assert(stats.live == 0);
+}
+
+// strings are searched through the entries, ints through the keys copied into the nodes
+void mixed_key_kinds() {
+  bimap<std::string, int, std::less<>, std::less<>, bimap_components::btree_storage<2>> b;
+  for (int i = 0; i < 300; ++i) {
+    b.insert(std::to_string(i * 7 % 300), i);
+  }
+  for (int i = 0; i < 300; i += 3) {
+    b.erase_right(i);
+  }
+  for (int i = 0; i < 300; ++i) {
+    auto it = b.find_left(std::to_string(i * 7 % 300));
+    assert((it != b.end_left()) == (i % 3 != 0));
+    assert(b.find_right(i) == (i % 3 != 0 ? it.flip() : b.end_right()));
+  }
+  assert(b.lower_bound_left("10") != b.end_left() && *b.lower_bound_left("10") == "10");
+  assert(*b.lower_bound_right(150) == 151);
+}
+
+} // namespace
+
+int main() {
+  nodes_use_allocator();
+  pool_serves_nodes();
+  matches_model();
+  mixed_key_kinds();
+}
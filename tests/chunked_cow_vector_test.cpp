@@ -0,0 +1,174 @@
+#include "../socow-vector/chunked-cow-vector.h"
+
+#include <cassert>
+#include <cstddef>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+// 16 ints per chunk, so that small vectors already span many chunks
+using ints = chunked_cow_vector<int, 64>;
+
+static_assert(ints::CHUNK_SIZE == 16);
+
+const int* address(const ints& v, std::size_t index) {
+  return &v[index];
+}
+
+template <typename V, typename T>
+bool same(const V& v, const std::vector<T>& model) {
+  if (v.size() != model.size()) {
+    return false;
+  }
+  std::size_t i = 0;
+  for (auto it = v.cbegin(); it != v.cend(); ++it, ++i) {
+    if (*it != model[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// a write through a copy copies the chunk it lands in and leaves every other chunk shared
+void write_copies_one_chunk() {
+  ints a;
+  for (int i = 0; i < 100; ++i) {
+    a.push_back(i);
+  }
+  ints b = a;
+  for (std::size_t i = 0; i < 100; ++i) {
+    assert(address(a, i) == address(b, i));
+  }
+
+  b[40] = -1;
+  for (std::size_t i = 0; i < 100; ++i) {
+    assert((address(a, i) == address(b, i)) == (i / 16 != 40 / 16));
+  }
+  assert(a[40] == 40 && b[40] == -1);
+
+  // the partially filled last chunk is shared too, appending to either side copies it
+  a.push_back(100);
+  assert(address(a, 96) != address(b, 96));
+  assert(address(a, 95) == address(b, 95));
+  assert(a.size() == 101 && b.size() == 100);
+  assert(address(a, 0) == address(b, 0));
+
+  // a mutable iterator unshares only the chunk it dereferences
+  ints c = b;
+  *(c.begin() + 3) = -3;
+  assert(address(c, 3) != address(b, 3) && address(c, 20) == address(b, 20));
+  assert(b[3] == 3 && c[3] == -3);
+}
+
+// reading through const access never unshares
+void reads_keep_sharing() {
+  ints a;
+  for (int i = 0; i < 64; ++i) {
+    a.push_back(i);
+  }
+  const ints b = a;
+  long sum = 0;
+  for (int value : b) {
+    sum += value;
+  }
+  for (auto it = a.cbegin(); it != a.cend(); ++it) {
+    sum += *it;
+  }
+  assert(sum == 2 * 63 * 64 / 2);
+  for (std::size_t i = 0; i < 64; ++i) {
+    assert(address(a, i) == address(b, i));
+  }
+}
+
+// random operations over a handful of vectors that copy each other, each checked against its own model
+template <typename T, typename Make>
+void matches_models(Make make) {
+  constexpr std::size_t VERSIONS = 4;
+  std::mt19937 rng(11);
+  std::vector<chunked_cow_vector<T, 64>> vs(VERSIONS);
+  std::vector<std::vector<T>> models(VERSIONS);
+  for (int step = 0; step < 20000; ++step) {
+    std::size_t k = rng() % VERSIONS;
+    auto& v = vs[k];
+    auto& model = models[k];
+    int value = static_cast<int>(rng() % 1000);
+    switch (rng() % 12) {
+    case 0:
+    case 1:
+    case 2:
+      v.push_back(make(value));
+      model.push_back(make(value));
+      break;
+    case 3:
+      if (!model.empty()) {
+        v.pop_back();
+        model.pop_back();
+      }
+      break;
+    case 4:
+    case 5:
+      if (!model.empty()) {
+        std::size_t i = rng() % model.size();
+        v[i] = make(value);
+        model[i] = make(value);
+      }
+      break;
+    case 6: {
+      std::size_t j = rng() % VERSIONS;
+      vs[j] = v;
+      models[j] = model;
+      break;
+    }
+    case 7: {
+      std::size_t i = rng() % (model.size() + 1);
+      v.insert(v.cbegin() + static_cast<std::ptrdiff_t>(i), make(value));
+      model.insert(model.begin() + static_cast<std::ptrdiff_t>(i), make(value));
+      break;
+    }
+    case 8:
+      if (!model.empty()) {
+        std::size_t first = rng() % model.size();
+        std::size_t last = first + rng() % (model.size() - first + 1);
+        v.erase(v.cbegin() + static_cast<std::ptrdiff_t>(first), v.cbegin() + static_cast<std::ptrdiff_t>(last));
+        model.erase(model.begin() + static_cast<std::ptrdiff_t>(first), model.begin() + static_cast<std::ptrdiff_t>(last));
+      }
+      break;
+    case 9: {
+      std::size_t j = rng() % VERSIONS;
+      vs[k].swap(vs[j]);
+      std::swap(models[k], models[j]);
+      break;
+    }
+    case 10:
+      if (rng() % 8 == 0) {
+        v.clear();
+        model.clear();
+      } else {
+        v.reserve(model.size() + rng() % 40);
+      }
+      break;
+    default: {
+      std::size_t j = rng() % VERSIONS;
+      auto moved = std::move(vs[j]);
+      vs[j] = std::move(moved);
+      v.shrink_to_fit();
+      break;
+    }
+    }
+    for (std::size_t i = 0; i < VERSIONS; ++i) {
+      assert(same(vs[i], models[i]));
+    }
+  }
+}
+
+} // namespace
+
+int main() {
+  write_copies_one_chunk();
+  reads_keep_sharing();
+  matches_models<int>([](int value) { return value; });
+  matches_models<std::string>([](int value) { return std::string(20 + value % 20, static_cast<char>('a' + value % 26)); });
+}
@@ -0,0 +1,208 @@
+#include "../bimap/concurrent-bimap.h"
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <map>
+#include <optional>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct model {
+  std::map<int, int> left;
+  std::map<int, int> right;
+
+  bool insert(int l, int r) {
+    if (left.count(l) != 0 || right.count(r) != 0) {
+      return false;
+    }
+    left[l] = r;
+    right[r] = l;
+    return true;
+  }
+
+  bool erase_left(int l) {
+    auto it = left.find(l);
+    if (it == left.end()) {
+      return false;
+    }
+    right.erase(it->second);
+    left.erase(it);
+    return true;
+  }
+
+  bool erase_right(int r) {
+    auto it = right.find(r);
+    return it != right.end() && erase_left(it->second);
+  }
+};
+
+template <typename K, typename V>
+std::optional<V> lookup(const std::map<K, V>& map, const K& key) {
+  auto it = map.find(key);
+  return it == map.end() ? std::nullopt : std::optional<V>(it->second);
+}
+
+void check(const concurrent_bimap<int, int>& b, const model& m, int keys) {
+  assert(b.size() == m.left.size());
+  for (int k = 0; k < keys; ++k) {
+    assert(b.find_left(k) == lookup(m.left, k));
+    assert(b.find_right(k) == lookup(m.right, k));
+  }
+}
+
+// a pair of the base that was erased and then inserted again lives in both halves of the delta
+void reinsert_over_base() {
+  bimap<int, int> init;
+  for (int i = 0; i < 10; ++i) {
+    init.insert(i, 100 + i);
+  }
+  concurrent_bimap<int, int> b(init);
+
+  assert(b.erase_left(3));
+  assert(!b.find_left(3) && !b.find_right(103));
+  assert(b.insert(3, 200));
+  assert(b.find_left(3) == 200 && b.find_right(200) == 3 && !b.find_right(103));
+  assert(!b.insert(3, 201) && !b.insert(4, 200));
+  assert(b.insert(11, 103));
+  assert(b.find_right(103) == 11);
+  assert(b.size() == 11);
+
+  assert(b.erase_right(200));
+  assert(!b.find_left(3) && !b.find_right(200));
+  assert(!b.erase_left(3));
+  assert(b.at_left(11) == 103 && b.at_right(109) == 9);
+  try {
+    b.at_left(3);
+    assert(false);
+  } catch (const std::out_of_range&) {}
+  assert(b.size() == 10);
+}
+
+// random writes push the delta past the folding threshold many times, every step is compared with the model
+void matches_model_through_folds() {
+  constexpr int KEYS = 600;
+  std::mt19937 rng(5);
+  bimap<int, int> init;
+  model m;
+  for (int i = 0; i < 300; ++i) {
+    int l = static_cast<int>(rng() % KEYS);
+    int r = static_cast<int>(rng() % KEYS);
+    if (m.insert(l, r)) {
+      init.insert(l, r);
+    }
+  }
+  concurrent_bimap<int, int> b(init);
+  check(b, m, KEYS);
+
+  for (int step = 0; step < 20000; ++step) {
+    int l = static_cast<int>(rng() % KEYS);
+    int r = static_cast<int>(rng() % KEYS);
+    switch (rng() % 4) {
+    case 0:
+    case 1:
+      assert(b.insert(l, r) == m.insert(l, r));
+      break;
+    case 2:
+      assert(b.erase_left(l) == m.erase_left(l));
+      break;
+    default:
+      assert(b.erase_right(r) == m.erase_right(r));
+      break;
+    }
+    assert(b.size() == m.left.size());
+    assert(b.find_left(l) == lookup(m.left, l));
+    assert(b.find_right(r) == lookup(m.right, r));
+    if (step % 500 == 0) {
+      check(b, m, KEYS);
+    }
+  }
+  check(b, m, KEYS);
+}
+
+// update sees the delta applied and starts the next one from its result
+void update_applies_batches() {
+  concurrent_bimap<int, int> b;
+  model m;
+  for (int i = 0; i < 100; ++i) {
+    assert(b.insert(i, -i));
+    m.insert(i, -i);
+  }
+  for (int i = 0; i < 100; i += 3) {
+    assert(b.erase_left(i));
+    m.erase_left(i);
+  }
+  std::size_t seen = b.update([](bimap<int, int>& snapshot) {
+    std::size_t res = snapshot.size();
+    for (int i = 100; i < 200; ++i) {
+      snapshot.insert(i, -i);
+    }
+    snapshot.erase_right(-1);
+    return res;
+  });
+  assert(seen == m.left.size());
+  for (int i = 100; i < 200; ++i) {
+    m.insert(i, -i);
+  }
+  m.erase_right(-1);
+  check(b, m, 200);
+
+  b.update([](bimap<int, int>& snapshot) { snapshot.erase_left(snapshot.begin_left(), snapshot.end_left()); });
+  assert(b.empty());
+  assert(b.insert(1, 1));
+  assert(b.read([](const concurrent_bimap<int, int>::view& v) { return v.size() == 1 && v.at_right(1) == 1; }));
+}
+
+// readers run against a writer that keeps every key k paired with -k, so each version they see is consistent;
+// readers yield between batches, so that the writer waiting for them is not starved on a single core
+void readers_see_consistent_versions() {
+  constexpr int KEYS = 2000;
+  concurrent_bimap<int, int> b;
+  for (int i = 0; i < KEYS; i += 2) {
+    b.insert(i, -i);
+  }
+  std::atomic<bool> stop{false};
+  std::atomic<int> failures{0};
+  std::vector<std::thread> readers;
+  for (int t = 0; t < 2; ++t) {
+    readers.emplace_back([&, t] {
+      std::mt19937 rng(static_cast<unsigned>(t));
+      while (!stop.load(std::memory_order_relaxed)) {
+        for (int i = 0; i < 64; ++i) {
+          int k = static_cast<int>(rng() % KEYS);
+          failures += b.read([k](const concurrent_bimap<int, int>::view& v) {
+            std::optional<int> r = v.find_left(k);
+            std::optional<int> l = v.find_right(-k);
+            return r.has_value() != l.has_value() || (r && (*r != -k || *l != k));
+          });
+        }
+        std::this_thread::yield();
+      }
+    });
+  }
+  std::mt19937 rng(99);
+  for (int step = 0; step < 2000; ++step) {
+    int k = static_cast<int>(rng() % KEYS);
+    if (!b.erase_left(k)) {
+      b.insert(k, -k);
+    }
+  }
+  stop = true;
+  for (std::thread& t : readers) {
+    t.join();
+  }
+  assert(failures == 0);
+}
+
+} // namespace
+
+int main() {
+  reinsert_over_base();
+  matches_model_through_folds();
+  update_applies_batches();
+  readers_see_consistent_versions();
+}
@@ -0,0 +1,120 @@
+#include "../bimap/flat-bimap.h"
+
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+using string_bimap = flat_bimap<std::string, std::string>;
+
+std::string key(char side, int i) {
+  return std::string(1, side) + "-key-long-enough-to-allocate-" + std::to_string(i);
+}
+
+string_bimap make(int n) {
+  string_bimap b;
+  for (int i = 0; i < n; ++i) {
+    b.insert(key('l', i), key('r', n - 1 - i));
+  }
+  return b;
+}
+
+void check_sorted_and_linked(const string_bimap& b) {
+  for (auto it = b.begin_left(); it != b.end_left(); ++it) {
+    if (std::next(it) != b.end_left()) {
+      assert(*it < *std::next(it));
+    }
+    assert(b.find_left(*it) == it);
+    assert(b.find_right(*it.flip()) == it.flip());
+  }
+  for (auto it = b.begin_right(); it != b.end_right(); ++it) {
+    if (std::next(it) != b.end_right()) {
+      assert(*it < *std::next(it));
+    }
+    assert(b.find_right(*it) == it);
+  }
+}
+
+// survivors before the erased range stay in place and must not be moved onto themselves
+void erase_left_range_keeps_prefix() {
+  string_bimap b = make(10);
+  b.erase_left(std::next(b.begin_left(), 3), std::next(b.begin_left(), 5));
+  assert(b.size() == 8);
+  check_sorted_and_linked(b);
+  for (int i : {0, 1, 2, 5, 9}) {
+    assert(b.at_left(key('l', i)) == key('r', 9 - i));
+  }
+  assert(b.find_left(key('l', 3)) == b.end_left());
+  assert(b.find_left(key('l', 4)) == b.end_left());
+}
+
+void erase_right_range_keeps_prefix() {
+  string_bimap b = make(10);
+  b.erase_right(std::next(b.begin_right(), 2), std::next(b.begin_right(), 6));
+  assert(b.size() == 6);
+  check_sorted_and_linked(b);
+  for (int i : {0, 1, 6, 7, 8, 9}) {
+    assert(b.at_right(key('r', i)) == key('l', 9 - i));
+  }
+}
+
+// a key whose copy throws while armed, to check that at_*_or_default leaves the container unchanged
+struct fragile {
+  static inline bool armed = false;
+
+  int value = 0;
+
+  fragile() = default;
+
+  explicit fragile(int value)
+      : value(value) {}
+
+  fragile(const fragile& other)
+      : value(other.value) {
+    if (armed) {
+      throw std::runtime_error("copy");
+    }
+  }
+
+  fragile(fragile&&) noexcept = default;
+  fragile& operator=(const fragile&) = default;
+  fragile& operator=(fragile&&) noexcept = default;
+
+  friend bool operator<(const fragile& l, const fragile& r) {
+    return l.value < r.value;
+  }
+
+  friend bool operator==(const fragile& l, const fragile& r) {
+    return l.value == r.value;
+  }
+};
+
+void at_or_default_keeps_pair_on_throw() {
+  flat_bimap<fragile, int> b;
+  b.insert(fragile(1), 0);
+  b.insert(fragile(2), 5);
+  fragile::armed = true;
+  bool thrown = false;
+  try {
+    b.at_left_or_default(fragile(3));
+  } catch (const std::runtime_error&) {
+    thrown = true;
+  }
+  fragile::armed = false;
+  assert(thrown);
+  assert(b.size() == 2);
+  assert(b.at_right(0) == fragile(1));
+  assert(b.at_left_or_default(fragile(3)) == 0);
+  assert(b.size() == 2 && b.find_left(fragile(1)) == b.end_left());
+}
+
+} // namespace
+
+int main() {
+  erase_left_range_keeps_prefix();
+  erase_right_range_keeps_prefix();
+  at_or_default_keeps_pair_on_throw();
+}
@@ -0,0 +1,105 @@
+#include "../matrix/matrix.h"
+
+#include <cassert>
+#include <cstddef>
+
+namespace {
+
+using lmatrix = matrix<long>;
+
+lmatrix make(std::size_t rows, std::size_t cols, long seed) {
+  lmatrix m(rows, cols);
+  for (std::size_t i = 0; i < m.size(); ++i) {
+    m.data()[i] = static_cast<long>((i * 7 + static_cast<std::size_t>(seed)) % 11) - 5;
+  }
+  return m;
+}
+
+lmatrix naive_product(const lmatrix& a, const lmatrix& b) {
+  lmatrix res(a.rows(), b.cols());
+  for (std::size_t i = 0; i < a.rows(); ++i) {
+    for (std::size_t j = 0; j < b.cols(); ++j) {
+      long sum = 0;
+      for (std::size_t k = 0; k < a.cols(); ++k) {
+        sum += a(i, k) * b(k, j);
+      }
+      res(i, j) = sum;
+    }
+  }
+  return res;
+}
+
+lmatrix naive_elementwise(const lmatrix& a, const lmatrix& b, long sign) {
+  lmatrix res(a.rows(), a.cols());
+  for (std::size_t i = 0; i < a.size(); ++i) {
+    res.data()[i] = a.data()[i] + sign * b.data()[i];
+  }
+  return res;
+}
+
+// an expression kept past the end of the full expression must own its temporary operands
+void temporaries_outlive_expression() {
+  lmatrix b = make(3, 3, 1);
+
+  auto sum = make(3, 3, 2) + b;
+  lmatrix r = sum;
+  assert(r == naive_elementwise(make(3, 3, 2), b, 1));
+
+  auto difference = b - make(3, 3, 4);
+  r = difference;
+  assert(r == naive_elementwise(b, make(3, 3, 4), -1));
+
+  auto product = make(3, 3, 3) * b;
+  r = product;
+  assert(r == naive_product(make(3, 3, 3), b));
+
+  auto scaled = 3L * make(3, 3, 5);
+  r = scaled;
+  lmatrix expected = make(3, 3, 5);
+  expected *= 3L;
+  assert(r == expected);
+
+  auto chained = (make(3, 3, 6) + make(3, 3, 7)) * make(3, 3, 8) + b;
+  r = chained;
+  lmatrix left = naive_elementwise(make(3, 3, 6), make(3, 3, 7), 1);
+  assert(r == naive_elementwise(naive_product(left, make(3, 3, 8)), b, 1));
+}
+
+void product_assigned_to_operand() {
+  lmatrix x = make(16, 16, 1);
+  lmatrix expected = naive_product(x, x);
+  x = x * x;
+  assert(x == expected);
+}
+
+void sum_with_product_of_destination() {
+  lmatrix s = make(16, 16, 2);
+  lmatrix y = make(16, 16, 3);
+  lmatrix expected = naive_elementwise(s, naive_product(y, y), 1);
+  y = s + y * y;
+  assert(y == expected);
+}
+
+void subtract_product_of_destination() {
+  lmatrix z = make(16, 16, 4);
+  lmatrix expected = naive_elementwise(z, naive_product(z, z), -1);
+  z -= z * z;
+  assert(z == expected);
+}
+
+void add_product_of_destination() {
+  lmatrix w = make(16, 16, 5);
+  lmatrix expected = naive_elementwise(w, naive_product(w, w), 1);
+  w += w * w;
+  assert(w == expected);
+}
+
+} // namespace
+
+int main() {
+  temporaries_outlive_expression();
+  product_assigned_to_operand();
+  sum_with_product_of_destination();
+  subtract_product_of_destination();
+  add_product_of_destination();
+}
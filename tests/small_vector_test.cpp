@@ -0,0 +1,80 @@
+#include "../socow-vector/small-vector.h"
+
+#include <cassert>
+#include <cstddef>
+#include <stdexcept>
+
+namespace {
+
+struct throwing_copy {
+  static inline std::size_t copies_left = 0;
+  static inline std::size_t alive = 0;
+
+  int value;
+
+  explicit throwing_copy(int value)
+      : value(value) {
+    ++alive;
+  }
+
+  throwing_copy(const throwing_copy& other)
+      : value(other.value) {
+    if (copies_left == 0) {
+      throw std::runtime_error("copy");
+    }
+    --copies_left;
+    ++alive;
+  }
+
+  ~throwing_copy() {
+    --alive;
+  }
+};
+
+// a copy that throws after the copy constructor moved to the heap must release the heap buffer once
+void copy_throws_after_reserve() {
+  {
+    small_vector<throwing_copy, 2> v;
+    throwing_copy::copies_left = 16;
+    for (int i = 0; i < 4; ++i) {
+      v.emplace_back(i);
+    }
+    throwing_copy::copies_left = 2;
+    bool thrown = false;
+    try {
+      small_vector<throwing_copy, 2> copy(v);
+    } catch (const std::runtime_error&) {
+      thrown = true;
+    }
+    assert(thrown);
+    assert(throwing_copy::alive == 4);
+    assert(v.size() == 4 && v[3].value == 3);
+  }
+  assert(throwing_copy::alive == 0);
+}
+
+void copy_throws_inline() {
+  {
+    small_vector<throwing_copy, 4> v;
+    throwing_copy::copies_left = 16;
+    v.emplace_back(1);
+    v.emplace_back(2);
+    throwing_copy::copies_left = 1;
+    bool thrown = false;
+    try {
+      small_vector<throwing_copy, 4> copy(v);
+    } catch (const std::runtime_error&) {
+      thrown = true;
+    }
+    assert(thrown);
+    assert(throwing_copy::alive == 2);
+  }
+  assert(throwing_copy::alive == 0);
+}
+
+} // namespace
+
+int main() {
+  copy_throws_after_reserve();
+  copy_throws_inline();
+}
@@ -0,0 +1,136 @@
+#include "../socow-vector/socow-vector.h"
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using socow_components::CACHE_LINE;
+
+static_assert(sizeof(compact_socow_vector<char>) == CACHE_LINE);
+static_assert(sizeof(compact_socow_vector<int>) == CACHE_LINE);
+static_assert(sizeof(compact_socow_vector<void*>) == CACHE_LINE);
+static_assert(sizeof(compact_socow_vector<double, 2>) == 2 * CACHE_LINE);
+static_assert(sizeof(compact_socow_vector<std::string>) == CACHE_LINE);
+
+static_assert(alignof(compact_socow_vector<char>) == CACHE_LINE);
+static_assert(alignof(compact_socow_vector<int>) == CACHE_LINE);
+static_assert(alignof(compact_socow_vector<void*>) == CACHE_LINE);
+static_assert(alignof(compact_socow_vector<double, 2>) == CACHE_LINE);
+static_assert(alignof(compact_socow_vector<std::string>) == CACHE_LINE);
+
+// the default alignment stays that of the members, so plain vectors do not grow
+static_assert(sizeof(socow_vector<int, 2>) == 2 * sizeof(std::size_t));
+static_assert(alignof(socow_vector<int, 2>) == alignof(std::size_t));
+static_assert(alignof(socow_vector<long double, 1>) == alignof(long double));
+
+// inline capacity fills whatever the size field leaves of the lines
+static_assert(socow_components::inline_capacity<char, CACHE_LINE> == CACHE_LINE - sizeof(std::size_t));
+static_assert(socow_components::inline_capacity<int, CACHE_LINE> == (CACHE_LINE - sizeof(std::size_t)) / sizeof(int));
+
+template <typename V>
+bool on_line_boundary(const V& v) {
+  return reinterpret_cast<std::uintptr_t>(&v) % CACHE_LINE == 0;
+}
+
+// each element of an array, a heap array or a std::vector starts its own line
+void elements_start_cache_lines() {
+  compact_socow_vector<int> local[3];
+  for (const auto& v : local) {
+    assert(on_line_boundary(v));
+  }
+
+  auto* heap = new compact_socow_vector<double, 2>[5];
+  for (std::size_t i = 0; i < 5; ++i) {
+    assert(on_line_boundary(heap[i]));
+  }
+  delete[] heap;
+
+  std::vector<compact_socow_vector<char>> vectors(7);
+  for (const auto& v : vectors) {
+    assert(on_line_boundary(v));
+  }
+}
+
+// the packed small flag survives moving between the inline buffer and the heap and back
+void inline_and_shared_storage() {
+  constexpr std::size_t INLINE = socow_components::inline_capacity<int, CACHE_LINE>;
+  compact_socow_vector<int> v;
+  for (std::size_t i = 0; i < INLINE; ++i) {
+    v.push_back(static_cast<int>(i));
+  }
+  assert(v.capacity() == INLINE);
+  assert(v.size() == INLINE);
+
+  v.push_back(static_cast<int>(INLINE));
+  assert(v.capacity() > INLINE);
+  compact_socow_vector<int> copy = v;
+  assert(copy.cdata() == v.cdata());
+
+  copy[0] = -1;
+  assert(copy.cdata() != v.cdata());
+  assert(v[0] == 0);
+  assert(copy[0] == -1);
+
+  while (v.size() > 2) {
+    v.pop_back();
+  }
+  v.shrink_to_fit();
+  assert(v.capacity() == INLINE);
+  assert(v.size() == 2 && v[0] == 0 && v[1] == 1);
+  assert(copy.size() == INLINE + 1 && copy[INLINE] == static_cast<int>(INLINE));
+}
+
+// workers copy one big buffer, read it, and either drop their copy or write to it while the others still share it;
+// every worker sees the original elements and its own writes only, and whichever thread lets go last frees the buffer
+void snapshots_across_threads() {
+  using shared = shared_socow_vector<std::string, 3>;
+  constexpr std::size_t SIZE = 1000;
+  constexpr std::size_t WORKERS = 8;
+  for (int round = 0; round < 50; ++round) {
+    shared source;
+    for (std::size_t i = 0; i < SIZE; ++i) {
+      source.push_back(std::to_string(i));
+    }
+    std::vector<shared> snapshots(WORKERS, source);
+    std::vector<int> failures(WORKERS, 0);
+    std::vector<std::thread> workers;
+    for (std::size_t w = 0; w < WORKERS; ++w) {
+      workers.emplace_back([&, w] {
+        shared local = snapshots[w];
+        snapshots[w] = shared();
+        for (std::size_t i = 0; i < SIZE; ++i) {
+          failures[w] += local.cview()[i] != std::to_string(i);
+        }
+        if (w % 2 == 0) {
+          return;
+        }
+        local[w] = "worker";
+        local.push_back("tail");
+        for (std::size_t i = 0; i < SIZE; ++i) {
+          failures[w] += local.cview()[i] != (i == w ? "worker" : std::to_string(i));
+        }
+        failures[w] += local.size() != SIZE + 1;
+      });
+    }
+    source = shared();
+    for (std::thread& t : workers) {
+      t.join();
+    }
+    for (int failed : failures) {
+      assert(failed == 0);
+    }
+  }
+}
+
+} // namespace
+
+int main() {
+  elements_start_cache_lines();
+  inline_and_shared_storage();
+  snapshots_across_threads();
+}
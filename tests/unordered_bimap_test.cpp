@@ -0,0 +1,66 @@
+#include "../bimap/unordered-bimap.h"
+
+#include <cassert>
+#include <cstddef>
+#include <functional>
+#include <stdexcept>
+
+namespace {
+
+// a key whose copy throws while armed, to check that at_*_or_default leaves the container unchanged
+struct fragile {
+  static inline bool armed = false;
+
+  int value = 0;
+
+  fragile() = default;
+
+  explicit fragile(int value)
+      : value(value) {}
+
+  fragile(const fragile& other)
+      : value(other.value) {
+    if (armed) {
+      throw std::runtime_error("copy");
+    }
+  }
+
+  fragile(fragile&&) noexcept = default;
+  fragile& operator=(const fragile&) = default;
+  fragile& operator=(fragile&&) noexcept = default;
+
+  friend bool operator==(const fragile& l, const fragile& r) {
+    return l.value == r.value;
+  }
+};
+
+struct fragile_hash {
+  std::size_t operator()(const fragile& f) const noexcept {
+    return std::hash<int>()(f.value);
+  }
+};
+
+void at_or_default_keeps_pair_on_throw() {
+  unordered_bimap<fragile, int, fragile_hash> b;
+  b.insert(fragile(1), 0);
+  b.insert(fragile(2), 5);
+  fragile::armed = true;
+  bool thrown = false;
+  try {
+    b.at_left_or_default(fragile(3));
+  } catch (const std::runtime_error&) {
+    thrown = true;
+  }
+  fragile::armed = false;
+  assert(thrown);
+  assert(b.size() == 2);
+  assert(b.at_right(0) == fragile(1));
+  assert(b.at_left_or_default(fragile(3)) == 0);
+  assert(b.size() == 2 && b.find_left(fragile(1)) == b.end_left());
+}
+
+} // namespace
+
+int main() {
+  at_or_default_keeps_pair_on_throw();
+}
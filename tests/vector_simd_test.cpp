@@ -0,0 +1,214 @@
+#include "../vector/vector-simd.h"
+#include "../vector/vector.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <limits>
+#include <vector>
+
+namespace {
+
+// every kernel the dispatch may pick, so that each one is checked whatever the processor runs by default
+template <typename T>
+struct kernels {
+  void (*fill)(T*, std::size_t, T);
+  bool (*equal)(const T*, const T*, std::size_t);
+  std::size_t (*find)(const T*, std::size_t, T);
+  std::size_t (*count)(const T*, std::size_t, T);
+};
+
+template <typename T>
+std::vector<kernels<T>> all_kernels() {
+  std::vector<kernels<T>> res{{vector_simd::fill<T>, vector_simd::equal<T>, vector_simd::find<T>, vector_simd::count<T>}};
+#if VECTOR_SIMD_X86
+  res.push_back(
+      {[](T* data, std::size_t n, T value) { vector_simd::lanes<T, 16>::fill(data, n, value); },
+       [](const T* a, const T* b, std::size_t n) { return vector_simd::lanes<T, 16>::equal(a, b, n); },
+       [](const T* data, std::size_t n, T value) { return vector_simd::lanes<T, 16>::find(data, n, value); },
+       [](const T* data, std::size_t n, T value) { return vector_simd::lanes<T, 16>::count(data, n, value); }}
+  );
+  if (vector_simd::has_avx2()) {
+    res.push_back(
+        {vector_simd::fill_avx2<T>, vector_simd::equal_avx2<T>, vector_simd::find_avx2<T>, vector_simd::count_avx2<T>}
+    );
+  }
+#endif
+  return res;
+}
+
+template <typename T>
+std::size_t scalar_find(const T* data, std::size_t n, T value) {
+  for (std::size_t i = 0; i < n; ++i) {
+    if (data[i] == value) {
+      return i;
+    }
+  }
+  return n;
+}
+
+template <typename T>
+std::size_t scalar_count(const T* data, std::size_t n, T value) {
+  std::size_t res = 0;
+  for (std::size_t i = 0; i < n; ++i) {
+    res += data[i] == value;
+  }
+  return res;
+}
+
+template <typename T>
+bool scalar_equal(const T* a, const T* b, std::size_t n) {
+  for (std::size_t i = 0; i < n; ++i) {
+    if (!(a[i] == b[i])) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// every length up to several unrolled blocks and every start offset within a register,
+// with the searched value placed in the body and in the tail
+template <typename T>
+void matches_scalar() {
+  constexpr std::size_t MAX_LENGTH = 300;
+  constexpr std::size_t MAX_OFFSET = 32 / sizeof(T);
+  std::vector<T> buffer(MAX_LENGTH + MAX_OFFSET);
+  std::vector<T> other(MAX_LENGTH + MAX_OFFSET);
+  for (const kernels<T>& k : all_kernels<T>()) {
+    for (std::size_t offset = 0; offset < MAX_OFFSET; ++offset) {
+      for (std::size_t n = 0; n <= MAX_LENGTH; ++n) {
+        T* data = buffer.data() + offset;
+        for (std::size_t i = 0; i < n; ++i) {
+          data[i] = static_cast<T>(i % 5);
+        }
+        assert(k.count(data, n, T(3)) == scalar_count(data, n, T(3)));
+        assert(k.find(data, n, T(4)) == scalar_find(data, n, T(4)));
+        assert(k.find(data, n, T(7)) == n);
+        if (n != 0) {
+          data[n - 1] = T(7);
+          assert(k.find(data, n, T(7)) == n - 1);
+          assert(k.count(data, n, T(7)) == 1);
+        }
+
+        T* copy = other.data() + (MAX_OFFSET - 1 - offset);
+        std::copy(data, data + n, copy);
+        assert(k.equal(data, copy, n));
+        for (std::size_t i = 0; i < n; i += 1 + n / 7) {
+          copy[i] = T(9);
+          assert(k.equal(data, copy, n) == scalar_equal(data, copy, n));
+          assert(!k.equal(data, copy, n));
+          copy[i] = data[i];
+        }
+
+        if (offset > 0) {
+          data[-1] = T(1);
+        }
+        data[n] = T(1);
+        k.fill(data, n, T(6));
+        assert(scalar_count(data, n, T(6)) == n);
+        assert(offset == 0 || data[-1] == T(1));
+        assert(data[n] == T(1));
+      }
+    }
+  }
+}
+
+// narrow lane counters are flushed before they wrap
+template <typename T>
+void count_does_not_wrap() {
+  std::vector<T> data(100'000, T(1));
+  for (const kernels<T>& k : all_kernels<T>()) {
+    assert(k.count(data.data(), data.size(), T(1)) == data.size());
+    assert(k.count(data.data(), data.size(), T(0)) == 0);
+  }
+}
+
+// NaN equals nothing, itself included, and -0.0 equals 0.0, as with the scalar ==
+template <typename T>
+void floating_point_semantics() {
+  const T nan = std::numeric_limits<T>::quiet_NaN();
+  for (std::size_t n : {std::size_t(5), std::size_t(64), std::size_t(1000)}) {
+    std::vector<T> a(n, T(1));
+    a[n / 2] = nan;
+    a[n - 1] = T(-0.0);
+    std::vector<T> b = a;
+    b[n - 1] = T(0.0);
+    for (const kernels<T>& k : all_kernels<T>()) {
+      assert(k.find(a.data(), n, nan) == n);
+      assert(k.count(a.data(), n, nan) == 0);
+      assert(!k.equal(a.data(), a.data(), n));
+      assert(k.find(a.data(), n, T(0.0)) == n - 1);
+      assert(k.count(a.data(), n, T(0.0)) == 1);
+      assert(k.count(b.data(), n, T(-0.0)) == 1);
+
+      std::vector<T> c = a;
+      c[n / 2] = T(1);
+      std::vector<T> d = b;
+      d[n / 2] = T(1);
+      assert(k.equal(c.data(), d.data(), n));
+
+      k.fill(c.data(), n, nan);
+      for (T value : c) {
+        assert(std::isnan(value));
+      }
+      k.fill(c.data(), n, T(-0.0));
+      assert(std::signbit(c[0]) && std::signbit(c[n - 1]));
+    }
+  }
+}
+
+// the members of vector agree with the free kernels
+template <typename T>
+void vector_members() {
+  for (std::size_t n : {std::size_t(0), std::size_t(3), std::size_t(17), std::size_t(100), std::size_t(1001)}) {
+    vector<T> v;
+    for (std::size_t i = 0; i < n; ++i) {
+      v.push_back(static_cast<T>(i % 11));
+    }
+    vector<T> w = v;
+    assert(v == w);
+    assert(v.count(T(10)) == scalar_count(v.data(), n, T(10)));
+    assert(static_cast<std::size_t>(v.find(T(10)) - v.begin()) == scalar_find(v.data(), n, T(10)));
+    assert(v.find(T(12)) == v.end());
+    if (n != 0) {
+      w[n - 1] = T(12);
+      assert(v != w);
+      assert(w.find(T(12)) == w.end() - 1);
+    }
+    v.fill(T(5));
+    assert(v.count(T(5)) == n);
+  }
+  vector<T> shorter;
+  shorter.resize(3, T(1));
+  vector<T> longer;
+  longer.resize(4, T(1));
+  assert(shorter != longer);
+}
+
+} // namespace
+
+int main() {
+  matches_scalar<std::int8_t>();
+  matches_scalar<std::uint8_t>();
+  matches_scalar<std::int16_t>();
+  matches_scalar<std::int32_t>();
+  matches_scalar<std::uint32_t>();
+  matches_scalar<std::int64_t>();
+  matches_scalar<float>();
+  matches_scalar<double>();
+
+  count_does_not_wrap<std::int8_t>();
+  count_does_not_wrap<std::uint8_t>();
+  count_does_not_wrap<std::int16_t>();
+  count_does_not_wrap<std::int32_t>();
+
+  floating_point_semantics<float>();
+  floating_point_semantics<double>();
+
+  vector_members<std::int32_t>();
+  vector_members<float>();
+  vector_members<std::uint16_t>();
+}
@@ -0,0 +1,300 @@
+#include "../vector/vector.h"
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <ratio>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct allocation_stats {
+  std::size_t allocations = 0;
+  std::size_t live = 0;
+};
+
+// counts every allocation made through any rebind of it
+template <typename T>
+class counting_allocator {
+  template <typename U>
+  friend class counting_allocator;
+
+public:
+  using value_type = T;
+
+  explicit counting_allocator(allocation_stats* stats) noexcept
+      : stats_(stats) {}
+
+  template <typename U>
+  counting_allocator(const counting_allocator<U>& other) noexcept
+      : stats_(other.stats_) {}
+
+  T* allocate(std::size_t n) {
+    ++stats_->allocations;
+    ++stats_->live;
+    return std::allocator<T>().allocate(n);
+  }
+
+  void deallocate(T* ptr, std::size_t n) noexcept {
+    --stats_->live;
+    std::allocator<T>().deallocate(ptr, n);
+  }
+
+  allocation_stats* stats() const noexcept {
+    return stats_;
+  }
+
+  template <typename U>
+  friend bool operator==(const counting_allocator& l, const counting_allocator<U>& r) noexcept {
+    return l.stats_ == r.stats_;
+  }
+
+private:
+  allocation_stats* stats_;
+};
+
+// copying throws once copies_left runs out; moving may throw too, so growth has to copy
+struct throwing_copy {
+  static inline std::size_t copies_left = SIZE_MAX;
+  static inline std::size_t alive = 0;
+
+  int value;
+
+  explicit throwing_copy(int value)
+      : value(value) {
+    ++alive;
+  }
+
+  throwing_copy(const throwing_copy& other)
+      : value(other.value) {
+    if (copies_left == 0) {
+      throw std::runtime_error("copy");
+    }
+    --copies_left;
+    ++alive;
+  }
+
+  throwing_copy(throwing_copy&& other) noexcept(false)
+      : throwing_copy(static_cast<const throwing_copy&>(other)) {}
+
+  throwing_copy& operator=(const throwing_copy&) = default;
+
+  ~throwing_copy() {
+    --alive;
+  }
+};
+
+// never copied while growing, since its move cannot throw
+struct counted_move {
+  static inline std::size_t copies = 0;
+
+  int value;
+
+  explicit counted_move(int value)
+      : value(value) {}
+
+  counted_move(const counted_move& other)
+      : value(other.value) {
+    ++copies;
+  }
+
+  counted_move(counted_move&& other) noexcept
+      : value(other.value) {}
+
+  counted_move& operator=(const counted_move&) = default;
+  counted_move& operator=(counted_move&&) noexcept = default;
+};
+
+template <typename V>
+bool same(const V& v, const std::vector<int>& model) {
+  if (v.size() != model.size()) {
+    return false;
+  }
+  for (std::size_t i = 0; i < model.size(); ++i) {
+    if (v[i] != model[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// storage of every element type comes from the allocator and returns to it, also for trivial ones
+void storage_uses_allocator() {
+  allocation_stats stats;
+  {
+    counting_allocator<int> alloc(&stats);
+    vector<int, counting_allocator<int>> v(alloc);
+    for (int i = 0; i < 100; ++i) {
+      v.push_back(i);
+    }
+    assert(stats.allocations > 0);
+    assert(v.get_allocator().stats() == &stats);
+
+    vector<int, counting_allocator<int>> copy = v;
+    assert(copy == v);
+    v.insert(v.begin() + 50, 10, -1);
+    v.erase(v.begin(), v.begin() + 20);
+    v.shrink_to_fit();
+    assert(v.capacity() == v.size());
+
+    counting_allocator<std::string> string_alloc(&stats);
+    vector<std::string, counting_allocator<std::string>> strings(string_alloc);
+    for (int i = 0; i < 50; ++i) {
+      strings.emplace_back(40, static_cast<char>('a' + i % 26));
+    }
+    strings.insert(strings.begin(), "front");
+    assert(strings[0] == "front" && strings[1] == std::string(40, 'a'));
+  }
+  assert(stats.live == 0);
+}
+
+// trivially copyable elements grow through realloc; every operation is checked against std::vector
+void realloc_storage_matches_model() {
+  vector<int> v;
+  std::vector<int> model;
+  for (int i = 0; i < 1000; ++i) {
+    v.push_back(i);
+    model.push_back(i);
+  }
+  assert(same(v, model));
+
+  v.insert(v.begin() + 10, 500, 7);
+  model.insert(model.begin() + 10, 500, 7);
+  assert(same(v, model));
+
+  int source[] = {1, 2, 3, 4, 5};
+  v.insert(v.begin() + 3, std::begin(source), std::end(source));
+  model.insert(model.begin() + 3, std::begin(source), std::end(source));
+  assert(same(v, model));
+
+  v.erase(v.begin() + 100, v.begin() + 700);
+  model.erase(model.begin() + 100, model.begin() + 700);
+  assert(same(v, model));
+
+  v.resize(2000);
+  model.resize(2000);
+  assert(same(v, model));
+
+  v.resize(3000, 9);
+  model.resize(3000, 9);
+  assert(same(v, model));
+
+  v.resize(10);
+  model.resize(10);
+  v.shrink_to_fit();
+  assert(v.capacity() == 10 && same(v, model));
+
+  v.resize_uninitialized(20);
+  assert(v.size() == 20 && v[9] == model[9]);
+
+  // the argument refers into the buffer that growth reallocates
+  v.resize(10);
+  v.shrink_to_fit();
+  v.push_back(v[0]);
+  v.insert(v.begin(), 5, v[3]);
+  model.push_back(model[0]);
+  model.insert(model.begin(), 5, model[3]);
+  assert(same(v, model));
+
+  v.clear();
+  v.shrink_to_fit();
+  assert(v.empty() && v.capacity() == 0);
+}
+
+void growth_factor() {
+  vector<int, std::allocator<int>, std::ratio<3, 2>> v;
+  std::size_t expected = 0;
+  for (int i = 0; i < 1000; ++i) {
+    if (v.size() == v.capacity()) {
+      expected = expected * 3 / 2 + 1;
+    }
+    v.push_back(i);
+    assert(v.capacity() == expected);
+  }
+}
+
+// elements that move without throwing are moved into the new buffer
+void growth_moves_nothrow_elements() {
+  vector<counted_move> v;
+  for (int i = 0; i < 1000; ++i) {
+    v.emplace_back(i);
+  }
+  v.insert(v.begin() + 500, counted_move(-1));
+  v.erase(v.begin());
+  assert(counted_move::copies == 0);
+  assert(v.size() == 1000 && v[499].value == -1);
+}
+
+template <typename V>
+void assert_values(const V& v, std::size_t size, int last) {
+  assert(v.size() == size);
+  for (std::size_t i = 0; i < size; ++i) {
+    assert(v[i].value == (i + 1 == size ? last : static_cast<int>(i)));
+  }
+}
+
+// a copy that throws while the vector grows or inserts leaves it exactly as it was
+void strong_guarantee() {
+  {
+    vector<throwing_copy> v;
+    for (int i = 0; i < 8; ++i) {
+      v.emplace_back(i);
+    }
+    v.shrink_to_fit();
+    const throwing_copy* before = v.data();
+
+    throwing_copy::copies_left = 3;
+    try {
+      v.push_back(throwing_copy(8));
+      assert(false);
+    } catch (const std::runtime_error&) {}
+    assert(v.data() == before && v.capacity() == 8);
+    assert_values(v, 8, 7);
+
+    throwing_copy::copies_left = 5;
+    try {
+      v.insert(v.begin() + 2, throwing_copy(-1));
+      assert(false);
+    } catch (const std::runtime_error&) {}
+    assert(v.data() == before);
+    assert_values(v, 8, 7);
+
+    throwing_copy::copies_left = 2;
+    try {
+      v.insert(v.begin() + 4, 3, throwing_copy(-1));
+      assert(false);
+    } catch (const std::runtime_error&) {}
+    assert_values(v, 8, 7);
+
+    throwing_copy::copies_left = 4;
+    try {
+      v.resize(20, throwing_copy(-1));
+      assert(false);
+    } catch (const std::runtime_error&) {}
+    assert_values(v, 8, 7);
+
+    throwing_copy::copies_left = 3;
+    try {
+      vector<throwing_copy> copy = v;
+      assert(false);
+    } catch (const std::runtime_error&) {}
+
+    throwing_copy::copies_left = SIZE_MAX;
+    v.push_back(throwing_copy(8));
+    assert_values(v, 9, 8);
+  }
+  assert(throwing_copy::alive == 0);
+}
+
+} // namespace
+
+int main() {
+  storage_uses_allocator();
+  realloc_storage_matches_model();
+  growth_factor();
+  growth_moves_nothrow_elements();
+  strong_guarantee();
+}
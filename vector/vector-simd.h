@@ -0,0 +1,216 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+
+#if defined(__GNUC__) && defined(__SSE2__)
+#define VECTOR_SIMD_X86 1
+#else
+#define VECTOR_SIMD_X86 0
+#endif
+
+namespace vector_simd {
+
+// element types whose == is lane-wise comparable; floating point keeps its own semantics (NaN, -0.0)
+template <typename T>
+inline constexpr bool SUPPORTED = std::is_arithmetic_v<T> && !std::is_same_v<T, bool> &&
+                                  (sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4 || sizeof(T) == 8);
+
+#if VECTOR_SIMD_X86
+
+// 32-byte vectors only cross function boundaries inside always inlined kernels
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpsabi"
+
+// generic kernels over W-byte registers, always inlined into the target-specific wrappers below
+// so that the same body compiles to SSE2 or AVX2 instructions
+template <typename T, std::size_t W>
+struct lanes {
+  using vec [[gnu::vector_size(W)]] = T;
+  static constexpr std::size_t COUNT = W / sizeof(T);
+
+  __attribute__((always_inline)) static vec load(const T* p) noexcept {
+    vec v;
+    std::memcpy(&v, p, W);
+    return v;
+  }
+
+  __attribute__((always_inline)) static vec broadcast(T value) noexcept {
+    vec v;
+    for (std::size_t i = 0; i < COUNT; ++i) {
+      v[i] = value;
+    }
+    return v;
+  }
+
+  template <typename Mask>
+  __attribute__((always_inline)) static bool any(const Mask& mask) noexcept {
+    std::int64_t w[W / 8];
+    std::memcpy(w, &mask, W);
+    std::int64_t res = 0;
+    for (std::size_t i = 0; i < W / 8; ++i) {
+      res |= w[i];
+    }
+    return res != 0;
+  }
+
+  __attribute__((always_inline)) static void fill(T* data, std::size_t n, T value) noexcept {
+    vec v = broadcast(value);
+    std::size_t i = 0;
+    for (; i + COUNT <= n; i += COUNT) {
+      std::memcpy(data + i, &v, W);
+    }
+    for (; i < n; ++i) {
+      data[i] = value;
+    }
+  }
+
+  __attribute__((always_inline)) static bool equal(const T* a, const T* b, std::size_t n) noexcept {
+    std::size_t i = 0;
+    for (; i + 4 * COUNT <= n; i += 4 * COUNT) {
+      auto diff = ~(load(a + i) == load(b + i)) | ~(load(a + i + COUNT) == load(b + i + COUNT)) |
+                  ~(load(a + i + 2 * COUNT) == load(b + i + 2 * COUNT)) |
+                  ~(load(a + i + 3 * COUNT) == load(b + i + 3 * COUNT));
+      if (any(diff)) {
+        return false;
+      }
+    }
+    for (; i < n; ++i) {
+      if (!(a[i] == b[i])) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  __attribute__((always_inline)) static std::size_t find(const T* data, std::size_t n, T value) noexcept {
+    vec v = broadcast(value);
+    std::size_t i = 0;
+    for (; i + 4 * COUNT <= n; i += 4 * COUNT) {
+      auto hit = (load(data + i) == v) | (load(data + i + COUNT) == v) | (load(data + i + 2 * COUNT) == v) |
+                 (load(data + i + 3 * COUNT) == v);
+      if (any(hit)) {
+        break;
+      }
+    }
+    for (; i < n; ++i) {
+      if (data[i] == value) {
+        return i;
+      }
+    }
+    return n;
+  }
+
+  // lanes count matches as -1 each, narrow counters are flushed before they can wrap
+  __attribute__((always_inline)) static std::size_t count(const T* data, std::size_t n, T value) noexcept {
+    using mask = decltype(std::declval<vec>() == std::declval<vec>());
+    using counter = std::conditional_t<
+        sizeof(T) == 1,
+        std::int8_t,
+        std::conditional_t<sizeof(T) == 2, std::int16_t, std::conditional_t<sizeof(T) == 4, std::int32_t, std::int64_t>>>;
+    constexpr std::size_t FLUSH = sizeof(counter) < 8 ? (std::size_t(1) << (8 * sizeof(counter) - 1)) - 1 : SIZE_MAX;
+    vec v = broadcast(value);
+    std::size_t res = 0;
+    std::size_t i = 0;
+    while (i + COUNT <= n) {
+      mask acc{};
+      for (std::size_t k = 0; k < FLUSH && i + COUNT <= n; ++k, i += COUNT) {
+        acc += (load(data + i) == v);
+      }
+      for (std::size_t k = 0; k < COUNT; ++k) {
+        res += static_cast<std::size_t>(-static_cast<std::int64_t>(static_cast<counter>(acc[k])));
+      }
+    }
+    for (; i < n; ++i) {
+      res += data[i] == value;
+    }
+    return res;
+  }
+};
+
+template <typename T>
+__attribute__((target("avx2"))) void fill_avx2(T* data, std::size_t n, T value) noexcept {
+  lanes<T, 32>::fill(data, n, value);
+}
+
+template <typename T>
+__attribute__((target("avx2"))) bool equal_avx2(const T* a, const T* b, std::size_t n) noexcept {
+  return lanes<T, 32>::equal(a, b, n);
+}
+
+template <typename T>
+__attribute__((target("avx2"))) std::size_t find_avx2(const T* data, std::size_t n, T value) noexcept {
+  return lanes<T, 32>::find(data, n, value);
+}
+
+template <typename T>
+__attribute__((target("avx2"))) std::size_t count_avx2(const T* data, std::size_t n, T value) noexcept {
+  return lanes<T, 32>::count(data, n, value);
+}
+
+#pragma GCC diagnostic pop
+
+inline bool has_avx2() noexcept {
+  static const bool result = [] {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") != 0;
+  }();
+  return result;
+}
+
+#endif
+
+// below this many bytes the dispatch costs more than it saves
+inline constexpr std::size_t MIN_BYTES = 64;
+
+template <typename T>
+void fill(T* data, std::size_t n, T value) noexcept {
+#if VECTOR_SIMD_X86
+  if (n * sizeof(T) >= MIN_BYTES) {
+    if (has_avx2()) {
+      fill_avx2(data, n, value);
+    } else {
+      lanes<T, 16>::fill(data, n, value);
+    }
+    return;
+  }
+#endif
+  std::fill(data, data + n, value);
+}
+
+template <typename T>
+bool equal(const T* a, const T* b, std::size_t n) noexcept {
+#if VECTOR_SIMD_X86
+  if (n * sizeof(T) >= MIN_BYTES) {
+    return has_avx2() ? equal_avx2(a, b, n) : lanes<T, 16>::equal(a, b, n);
+  }
+#endif
+  return std::equal(a, a + n, b);
+}
+
+// index of the first element equal to value or n
+template <typename T>
+std::size_t find(const T* data, std::size_t n, T value) noexcept {
+#if VECTOR_SIMD_X86
+  if (n * sizeof(T) >= MIN_BYTES) {
+    return has_avx2() ? find_avx2(data, n, value) : lanes<T, 16>::find(data, n, value);
+  }
+#endif
+  return static_cast<std::size_t>(std::find(data, data + n, value) - data);
+}
+
+template <typename T>
+std::size_t count(const T* data, std::size_t n, T value) noexcept {
+#if VECTOR_SIMD_X86
+  if (n * sizeof(T) >= MIN_BYTES) {
+    return has_avx2() ? count_avx2(data, n, value) : lanes<T, 16>::count(data, n, value);
+  }
+#endif
+  return static_cast<std::size_t>(std::count(data, data + n, value));
+}
+
+} // namespace vector_simd
@@ -1,12 +1,47 @@
 #pragma once
 
+#include "vector-simd.h"
+
+#include <algorithm>
 #include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iterator>
 #include <memory>
+#include <new>
+#include <ratio>
+#include <type_traits>
+#include <utility>
+
+// selects the overloads that default-initialize new elements, so trivial ones keep indeterminate values
+struct default_init_t {
+  explicit default_init_t() = default;
+};
 
-template <typename T>
+inline constexpr default_init_t default_init{};
+
+// GrowthFactor is a std::ratio the capacity is multiplied by when the vector is full
+template <typename T, typename Allocator = std::allocator<T>, typename GrowthFactor = std::ratio<2>>
 class vector {
+  static_assert(std::ratio_greater_v<GrowthFactor, std::ratio<1>>, "growth factor must be greater than one");
+
+  using alloc_traits = std::allocator_traits<Allocator>;
+
+  static_assert(std::is_same_v<typename alloc_traits::pointer, T*>, "allocator must use raw pointers");
+
+  // the default allocator only does placement new, so such elements may be copied byte by byte
+  static constexpr bool TRIVIAL_COPY = std::is_trivially_copyable_v<T> && std::is_same_v<Allocator, std::allocator<T>>;
+
+  // storage of such elements comes from malloc and grows with realloc, which often extends the block in place
+  static constexpr bool REALLOCATABLE = TRIVIAL_COPY && alignof(T) <= alignof(std::max_align_t);
+
+  // fill, comparison and search of such elements go through the vectorized kernels of vector-simd.h
+  static constexpr bool SIMD = vector_simd::SUPPORTED<T>;
+
 public:
   using value_type = T;
+  using allocator_type = Allocator;
   using reference = T&;
   using const_reference = const T&;
   using pointer = T*;
@@ -18,60 +53,234 @@ private:
   pointer _data;
   size_t _size;
   size_t _capacity;
+  [[no_unique_address]] Allocator _alloc;
 
-  static void destroy(pointer p, size_t count) {
-    for (size_t i = 0; i < count; ++i) {
-      p[count - i - 1].~T();
+  pointer allocate(size_t count) {
+    if constexpr (REALLOCATABLE) {
+      pointer p = static_cast<pointer>(std::malloc(count * sizeof(T)));
+      if (p == nullptr) {
+        throw std::bad_alloc();
+      }
+      return p;
+    } else {
+      return alloc_traits::allocate(_alloc, count);
     }
   }
 
-  static void copy_from(pointer source, pointer dest, size_t count) {
-    for (size_t i = 0; i < count; ++i) {
-      try {
-        new (dest + i) T(source[i]);
-      } catch (...) {
-        destroy(dest, i);
-        operator delete(dest);
-        throw;
+  void deallocate(pointer p, size_t count) noexcept {
+    if constexpr (REALLOCATABLE) {
+      std::free(p);
+    } else if (p != nullptr) {
+      alloc_traits::deallocate(_alloc, p, count);
+    }
+  }
+
+  void destroy(pointer p, size_t count) noexcept {
+    if constexpr (!std::is_trivially_destructible_v<T>) {
+      for (size_t i = 0; i < count; ++i) {
+        alloc_traits::destroy(_alloc, p + count - i - 1);
       }
     }
   }
 
-  void resize(size_t newcapacity) {
+  // on failure nothing is left constructed in dest
+  void copy_from(const_pointer source, pointer dest, size_t count) {
+    if constexpr (TRIVIAL_COPY) {
+      if (count != 0) {
+        std::memcpy(dest, source, count * sizeof(T));
+      }
+    } else {
+      for (size_t i = 0; i < count; ++i) {
+        try {
+          alloc_traits::construct(_alloc, dest + i, source[i]);
+        } catch (...) {
+          destroy(dest, i);
+          throw;
+        }
+      }
+    }
+  }
+
+  // moves the elements unless moving may throw and copying is possible, which keeps source intact on failure
+  void relocate(pointer source, pointer dest, size_t count) {
+    if constexpr (TRIVIAL_COPY) {
+      copy_from(source, dest, count);
+    } else {
+      for (size_t i = 0; i < count; ++i) {
+        try {
+          alloc_traits::construct(_alloc, dest + i, std::move_if_noexcept(source[i]));
+        } catch (...) {
+          destroy(dest, i);
+          throw;
+        }
+      }
+    }
+  }
+
+  // moves count elements from index from to index to, the slots left behind are unconstructed
+  void shift(size_t from, size_t to, size_t count) noexcept {
+    if constexpr (TRIVIAL_COPY) {
+      if (count != 0) {
+        std::memmove(data() + to, data() + from, count * sizeof(T));
+      }
+    } else {
+      for (size_t i = 0; i < count; ++i) {
+        size_t k = to > from ? count - i - 1 : i;
+        alloc_traits::construct(_alloc, data() + to + k, std::move(data()[from + k]));
+        alloc_traits::destroy(_alloc, data() + from + k);
+      }
+    }
+  }
+
+  void reallocate(size_t newcapacity) {
     if (newcapacity == 0) {
-      operator delete(data());
+      deallocate(data(), capacity());
       _data = nullptr;
       _capacity = 0;
       return;
     }
-    pointer newdata = static_cast<pointer>(operator new(newcapacity * sizeof(T)));
-    copy_from(_data, newdata, size());
-    destroy(data(), size());
-    operator delete(data());
+    if constexpr (REALLOCATABLE) {
+      pointer newdata = static_cast<pointer>(std::realloc(data(), newcapacity * sizeof(T)));
+      if (newdata == nullptr) {
+        throw std::bad_alloc();
+      }
+      _data = newdata;
+    } else {
+      pointer newdata = allocate(newcapacity);
+      try {
+        relocate(data(), newdata, size());
+      } catch (...) {
+        deallocate(newdata, newcapacity);
+        throw;
+      }
+      destroy(data(), size());
+      deallocate(data(), capacity());
+      _data = newdata;
+    }
     _capacity = newcapacity;
+  }
+
+  size_t grown_capacity() const noexcept {
+    return capacity() * GrowthFactor::num / GrowthFactor::den + 1;
+  }
+
+  size_t capacity_for(size_t count) const noexcept {
+    size_t grown = grown_capacity();
+    return grown < count ? count : grown;
+  }
+
+  // inserts count elements at pos, construct(dest, i) builds the i-th of them in raw memory.
+  // With a new buffer the elements are built before the old ones move, otherwise the tail is shifted once;
+  // if anything throws the vector is left unchanged
+  template <typename Construct>
+  iterator insert_with(size_t pos, size_t count, Construct construct) {
+    if (count == 0) {
+      return data() + pos;
+    }
+    size_t new_size = size() + count;
+    if constexpr (REALLOCATABLE) {
+      if (new_size > capacity()) {
+        reallocate(capacity_for(new_size));
+      }
+    }
+    if constexpr (TRIVIAL_COPY || std::is_nothrow_move_constructible_v<T>) {
+      if (new_size <= capacity()) {
+        shift(pos, pos + count, size() - pos);
+        size_t built = 0;
+        try {
+          for (; built < count; ++built) {
+            construct(data() + pos + built, built);
+          }
+        } catch (...) {
+          destroy(data() + pos, built);
+          shift(pos + count, pos, size() - pos);
+          throw;
+        }
+        _size = new_size;
+        return data() + pos;
+      }
+    }
+    size_t newcapacity = new_size <= capacity() ? capacity() : capacity_for(new_size);
+    pointer newdata = allocate(newcapacity);
+    size_t built = 0;
+    try {
+      for (; built < count; ++built) {
+        construct(newdata + pos + built, built);
+      }
+      relocate(data(), newdata, pos);
+      try {
+        relocate(data() + pos, newdata + pos + count, size() - pos);
+      } catch (...) {
+        destroy(newdata, pos);
+        throw;
+      }
+    } catch (...) {
+      destroy(newdata + pos, built);
+      deallocate(newdata, newcapacity);
+      throw;
+    }
+    destroy(data(), size());
+    deallocate(data(), capacity());
     _data = newdata;
+    _size = new_size;
+    _capacity = newcapacity;
+    return data() + pos;
+  }
+
+  void default_construct(pointer dest) {
+    if constexpr (std::is_same_v<Allocator, std::allocator<T>>) {
+      ::new (static_cast<void*>(dest)) T;
+    } else {
+      alloc_traits::construct(_alloc, dest);
+    }
+  }
+
+  void truncate(size_t count) noexcept {
+    destroy(data() + count, size() - count);
+    _size = count;
+  }
+
+  void swap_storage(vector& other) noexcept {
+    std::swap(_data, other._data);
+    std::swap(_size, other._size);
+    std::swap(_capacity, other._capacity);
+    std::swap(_alloc, other._alloc);
   }
 
 public:
-  vector() noexcept
+  vector() noexcept(std::is_nothrow_default_constructible_v<Allocator>)
+      : vector(Allocator()) {}
+
+  explicit vector(const Allocator& alloc) noexcept
       : _data(nullptr)
       , _size(0)
-      , _capacity(0) {}
+      , _capacity(0)
+      , _alloc(alloc) {}
 
-  vector(const vector& other) {
-    _capacity = other._size;
-    _size = other._size;
-    _data = nullptr;
-    if (size() != 0) {
-      _data = static_cast<pointer>(operator new(_capacity * sizeof(T)));
-      copy_from(other._data, _data, size());
+  vector(const vector& other)
+      : vector(other, alloc_traits::select_on_container_copy_construction(other._alloc)) {}
+
+  vector(const vector& other, const Allocator& alloc)
+      : vector(alloc) {
+    if (other.size() != 0) {
+      _data = allocate(other.size());
+      try {
+        copy_from(other.data(), _data, other.size());
+      } catch (...) {
+        deallocate(_data, other.size());
+        _data = nullptr;
+        throw;
+      }
+      _size = other.size();
+      _capacity = other.size();
     }
   }
 
-  vector(vector&& other) {
-    _size = other._size;
-    _capacity = other._capacity;
-    _data = other.data();
+  vector(vector&& other) noexcept
+      : _data(other._data)
+      , _size(other._size)
+      , _capacity(other._capacity)
+      , _alloc(std::move(other._alloc)) {
     other._data = nullptr;
     other._size = 0;
     other._capacity = 0;
@@ -81,19 +290,23 @@ public:
     if (data() == other.data()) {
       return *this;
     }
-    vector vec = other;
-    vec.swap(*this);
+    vector vec(other, alloc_traits::propagate_on_container_copy_assignment::value ? other._alloc : _alloc);
+    vec.swap_storage(*this);
     return *this;
   }
 
-  vector& operator=(vector&& other) {
-    other.swap(*this);
+  vector& operator=(vector&& other) noexcept {
+    other.swap_storage(*this);
     return *this;
   }
 
   ~vector() noexcept {
     destroy(data(), size());
-    operator delete(data());
+    deallocate(data(), capacity());
+  }
+
+  allocator_type get_allocator() const noexcept {
+    return _alloc;
   }
 
   reference operator[](size_t index) {
@@ -134,14 +347,19 @@ public:
 
   void push_back(T value) {
     if (size() == capacity()) {
-      resize(2 * capacity() + 1);
+      reallocate(grown_capacity());
     }
-    new (data() + size()) T(std::move(value));
+    alloc_traits::construct(_alloc, data() + size(), std::move(value));
     _size++;
   }
 
+  template <typename... Args>
+  reference emplace_back(Args&&... args) {
+    return *emplace(end(), std::forward<Args>(args)...);
+  }
+
   void pop_back() {
-    data()[size() - 1].~T();
+    alloc_traits::destroy(_alloc, data() + size() - 1);
     _size--;
   }
 
@@ -155,27 +373,55 @@ public:
 
   void reserve(size_t new_capacity) {
     if (new_capacity > capacity()) {
-      resize(new_capacity);
+      reallocate(new_capacity);
     }
   }
 
   void shrink_to_fit() {
     if (capacity() > size()) {
-      resize(size());
+      reallocate(size());
     }
   }
 
-  void clear() {
-    for (size_t i = 0; i < size(); ++i) {
-      data()[size() - i - 1].~T();
+  void clear() noexcept {
+    truncate(0);
+  }
+
+  void fill(const T& value) {
+    if constexpr (SIMD) {
+      vector_simd::fill(data(), size(), value);
+    } else {
+      std::fill(begin(), end(), value);
+    }
+  }
+
+  iterator find(const T& value) {
+    return begin() + (static_cast<const vector&>(*this).find(value) - begin());
+  }
+
+  const_iterator find(const T& value) const {
+    if constexpr (SIMD) {
+      return begin() + vector_simd::find(data(), size(), value);
+    } else {
+      return std::find(begin(), end(), value);
+    }
+  }
+
+  size_t count(const T& value) const {
+    if constexpr (SIMD) {
+      return vector_simd::count(data(), size(), value);
+    } else {
+      return static_cast<size_t>(std::count(begin(), end(), value));
     }
-    _size = 0;
   }
 
   void swap(vector& other) noexcept {
     std::swap(_data, other._data);
     std::swap(_size, other._size);
     std::swap(_capacity, other._capacity);
+    if constexpr (alloc_traits::propagate_on_container_swap::value) {
+      std::swap(_alloc, other._alloc);
+    }
   }
 
   iterator begin() noexcept {
@@ -194,13 +440,102 @@ public:
     return begin() + size();
   }
 
+  template <typename... Args>
+  iterator emplace(const_iterator pos, Args&&... args) {
+    size_t index = pos - begin();
+    if (!REALLOCATABLE && size() == capacity()) {
+      // the new buffer is filled before the old elements move, so args may refer into the vector
+      return insert_with(index, 1, [&](pointer dest, size_t) {
+        alloc_traits::construct(_alloc, dest, std::forward<Args>(args)...);
+      });
+    }
+    if (index == size() && size() != capacity()) {
+      alloc_traits::construct(_alloc, data() + size(), std::forward<Args>(args)...);
+      _size++;
+      return data() + index;
+    }
+    T value(std::forward<Args>(args)...);
+    return insert_with(index, 1, [&](pointer dest, size_t) { alloc_traits::construct(_alloc, dest, std::move(value)); });
+  }
+
   iterator insert(const_iterator pos, const T& value) {
-    size_t numpos = pos - begin();
-    push_back(value);
-    for (size_t i = 0; i < size() - numpos - 1; ++i) {
-      std::swap(data()[size() - i - 1], data()[size() - i - 2]);
+    return emplace(pos, value);
+  }
+
+  iterator insert(const_iterator pos, T&& value) {
+    return emplace(pos, std::move(value));
+  }
+
+  iterator insert(const_iterator pos, size_t count, const T& value) {
+    size_t index = pos - begin();
+    if (std::less_equal<const T*>()(data(), &value) && std::less<const T*>()(&value, data() + size())) {
+      T copy(value);
+      return insert_with(index, count, [&](pointer dest, size_t) { alloc_traits::construct(_alloc, dest, copy); });
+    }
+    return insert_with(index, count, [&](pointer dest, size_t) { alloc_traits::construct(_alloc, dest, value); });
+  }
+
+  // the range must not point into the vector
+  template <std::input_iterator It>
+  iterator insert(const_iterator pos, It first, It last) {
+    size_t index = pos - begin();
+    if constexpr (std::forward_iterator<It>) {
+      size_t count = static_cast<size_t>(std::distance(first, last));
+      return insert_with(index, count, [&](pointer dest, size_t) {
+        alloc_traits::construct(_alloc, dest, *first);
+        ++first;
+      });
+    } else {
+      vector buffer(_alloc);
+      for (; first != last; ++first) {
+        buffer.emplace_back(*first);
+      }
+      return insert_with(index, buffer.size(), [&](pointer dest, size_t i) {
+        alloc_traits::construct(_alloc, dest, std::move(buffer[i]));
+      });
+    }
+  }
+
+  // the range must not point into the vector
+  template <std::input_iterator It>
+  void assign(It first, It last) {
+    clear();
+    insert(end(), first, last);
+  }
+
+  void assign(size_t count, const T& value) {
+    T copy(value);
+    clear();
+    insert(end(), count, copy);
+  }
+
+  void resize(size_t count) {
+    if (count <= size()) {
+      truncate(count);
+      return;
+    }
+    insert_with(size(), count - size(), [this](pointer dest, size_t) { alloc_traits::construct(_alloc, dest); });
+  }
+
+  void resize(size_t count, default_init_t) {
+    if (count <= size()) {
+      truncate(count);
+      return;
     }
-    return data() + numpos;
+    insert_with(size(), count - size(), [this](pointer dest, size_t) { default_construct(dest); });
+  }
+
+  // grows without zeroing trivial elements, e.g. to hand data() to read(2) right away
+  void resize_uninitialized(size_t count) {
+    resize(count, default_init);
+  }
+
+  void resize(size_t count, const T& value) {
+    if (count <= size()) {
+      truncate(count);
+      return;
+    }
+    insert(end(), count - size(), value);
   }
 
   iterator erase(const_iterator pos) {
@@ -209,12 +544,30 @@ public:
 
   iterator erase(const_iterator first, const_iterator last) {
     size_t posl = first - begin(), posr = last - begin();
-    for (size_t i = 0; posr + i < size(); ++i) {
-      std::swap(data()[posl + i], data()[posr + i]);
+    if (posl == posr) {
+      return data() + posl;
     }
-    for (size_t i = 0; posl + i < posr; ++i) {
-      pop_back();
+    if constexpr (TRIVIAL_COPY) {
+      std::memmove(data() + posl, data() + posr, (size() - posr) * sizeof(T));
+    } else {
+      std::move(data() + posr, data() + size(), data() + posl);
     }
+    truncate(size() - (posr - posl));
     return data() + posl;
   }
+
+  friend bool operator==(const vector& l, const vector& r) {
+    if (l.size() != r.size()) {
+      return false;
+    }
+    if constexpr (SIMD) {
+      return vector_simd::equal(l.data(), r.data(), l.size());
+    } else {
+      return std::equal(l.begin(), l.end(), r.begin());
+    }
+  }
+
+  friend bool operator!=(const vector& l, const vector& r) {
+    return !(l == r);
+  }
 };